@@ -0,0 +1,159 @@
+#ifndef PHYSICSTEST_BENCH_UTILS_H
+#define PHYSICSTEST_BENCH_UTILS_H
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "generalUtils.h"
+}
+
+// runs the body until at least minTime seconds have passed, returns seconds per call
+template <typename Function>
+double measure(Function body, double minTime = 0.25) {
+
+    // warm up caches and branch predictors
+    body();
+
+    unsigned int iterations = 0;
+    double start = getTime();
+    double elapsed;
+
+    do {
+        body();
+        iterations++;
+        elapsed = getTime() - start;
+    } while (elapsed < minTime);
+
+    return elapsed / iterations;
+}
+
+// seconds of cpu time used by every thread of the process
+inline double getCpuTime() {
+
+    timespec time;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+
+    return (double) time.tv_sec + (double) time.tv_nsec * 1e-9;
+}
+
+struct Measurement {
+    unsigned int iterations;
+    // seconds per iteration
+    double realTime;
+    double cpuTime;
+};
+
+// like measure, but setup runs before every call outside the timed region
+template <typename Setup, typename Function>
+Measurement measureWithSetup(Setup setup, Function body, double minTime = 0.25) {
+
+    setup();
+    body();
+
+    Measurement result = { 0, 0, 0 };
+
+    do {
+        setup();
+
+        double start = getTime();
+        double cpuStart = getCpuTime();
+
+        body();
+
+        result.cpuTime += getCpuTime() - cpuStart;
+        result.realTime += getTime() - start;
+        result.iterations++;
+    } while (result.realTime < minTime);
+
+    result.realTime /= result.iterations;
+    result.cpuTime /= result.iterations;
+
+    return result;
+}
+
+// exactly count calls without a warm up, for bodies that change the state they run on
+template <typename Function>
+Measurement measureCount(Function body, unsigned int count) {
+
+    double start = getTime();
+    double cpuStart = getCpuTime();
+
+    for (unsigned int index = 0; index < count; index++)
+        body();
+
+    Measurement result = { count, (getTime() - start) / count, (getCpuTime() - cpuStart) / count };
+
+    return result;
+}
+
+// collects results in the google benchmark json format, so the dashboards read them like any other suite
+class JsonReport {
+private:
+    std::vector<std::string> entries;
+public:
+    // items are processed per iteration, reported as items_per_second
+    void add(const std::string& name, const Measurement& measurement, unsigned int items) {
+
+        char entry[512];
+        snprintf(entry, sizeof(entry),
+                 "    {\n"
+                 "      \"name\": \"%s\",\n"
+                 "      \"run_name\": \"%s\",\n"
+                 "      \"run_type\": \"iteration\",\n"
+                 "      \"repetitions\": 1,\n"
+                 "      \"repetition_index\": 0,\n"
+                 "      \"threads\": 1,\n"
+                 "      \"iterations\": %u,\n"
+                 "      \"real_time\": %.3f,\n"
+                 "      \"cpu_time\": %.3f,\n"
+                 "      \"time_unit\": \"ns\",\n"
+                 "      \"items_per_second\": %.1f\n"
+                 "    }",
+                 name.c_str(), name.c_str(), measurement.iterations, measurement.realTime * 1e9,
+                 measurement.cpuTime * 1e9, items / measurement.realTime);
+
+        entries.push_back(entry);
+    }
+
+    void write(FILE* file, const char* executable) {
+
+        char date[64];
+        time_t now = time(nullptr);
+        strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", localtime(&now));
+
+        char hostName[256] = "";
+        gethostname(hostName, sizeof(hostName) - 1);
+
+#ifdef __OPTIMIZE__
+        const char* buildType = "release";
+#else
+        const char* buildType = "debug";
+#endif
+
+        fprintf(file, "{\n  \"context\": {\n");
+        fprintf(file, "    \"date\": \"%s\",\n", date);
+        fprintf(file, "    \"host_name\": \"%s\",\n", hostName);
+        fprintf(file, "    \"executable\": \"%s\",\n", executable);
+        fprintf(file, "    \"num_cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+        fprintf(file, "    \"library_build_type\": \"%s\"\n", buildType);
+        fprintf(file, "  },\n  \"benchmarks\": [\n");
+
+        for (unsigned int index = 0; index < entries.size(); index++)
+            fprintf(file, "%s%s\n", entries[index].c_str(), index + 1 < entries.size() ? "," : "");
+
+        fprintf(file, "  ]\n}\n");
+    }
+};
+
+// keeps the optimizer from dropping computations whose result is unused
+template <typename T>
+void doNotOptimize(T const& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+#endif //PHYSICSTEST_BENCH_UTILS_H
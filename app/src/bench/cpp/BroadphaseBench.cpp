@@ -0,0 +1,117 @@
+// broadphase: pair generation cost per frame and how many of all possible pairs survive
+//
+// host build: the BroadphaseBench target of the host cmake build (app/CMakeLists.txt)
+
+#include <glm/glm.hpp>
+
+#include <stdlib.h>
+
+#include <vector>
+
+#include "BenchUtils.h"
+
+#include "Broadphase.h"
+
+using namespace glm;
+using namespace std;
+
+static float random(float min, float max) {
+    return min + (max - min) * (float)rand() / (float)RAND_MAX;
+}
+
+// boxes of 0.5 to 1.0 scattered at a fixed density, drifting a little every frame
+struct Scene {
+    vector<vec3> centers, halfSizes, velocities;
+    vector<Aabb> aabbs;
+    float extent;
+
+    Scene(unsigned int count) {
+
+        srand(1);
+
+        extent = cbrtf((float)count) * 1.5f;
+
+        for (unsigned int index = 0; index < count; index++) {
+            centers.push_back(vec3(random(0, extent), random(0, extent), random(0, extent)));
+            halfSizes.push_back(vec3(random(0.25f, 0.5f), random(0.25f, 0.5f), random(0.25f, 0.5f)));
+            velocities.push_back(vec3(random(-1, 1), random(-1, 1), random(-1, 1)) * 0.02f);
+        }
+
+        aabbs.resize(count);
+        updateAabbs();
+    }
+
+    void updateAabbs() {
+        for (unsigned int index = 0; index < centers.size(); index++)
+            aabbs[index] = { centers[index] - halfSizes[index], centers[index] + halfSizes[index] };
+    }
+
+    void move() {
+
+        for (unsigned int index = 0; index < centers.size(); index++) {
+
+            centers[index] += velocities[index];
+
+            // bounce off the domain walls
+            for (unsigned int axis = 0; axis < 3; axis++)
+                if (centers[index][axis] < 0 || centers[index][axis] > extent)
+                    velocities[index][axis] = -velocities[index][axis];
+        }
+
+        updateAabbs();
+    }
+};
+
+static unsigned int bruteForcePairCount(const Scene& scene) {
+
+    unsigned int count = 0;
+    for (unsigned int a = 0; a < scene.aabbs.size(); a++)
+        for (unsigned int b = a + 1; b < scene.aabbs.size(); b++)
+            if (scene.aabbs[a].overlaps(scene.aabbs[b]))
+                count++;
+
+    return count;
+}
+
+int main() {
+
+    const BroadphaseType TYPES[] = { SweepAndPrune, AabbTree, UniformGrid };
+    const unsigned int COUNTS[] = { 1000, 10000, 100000 };
+
+    printf("%18s %10s %14s %14s %12s %16s\n", "broadphase", "bodies", "ms per frame", "ns per body", "pairs", "culling ratio");
+
+    for (BroadphaseType type : TYPES) {
+        for (unsigned int count : COUNTS) {
+
+            Scene scene(count);
+            Aabb bounds = { vec3(0), vec3(scene.extent) };
+            Broadphase* broadphase = createBroadphase(type, bounds);
+            vector<BodyPair> pairs;
+
+            // first update builds everything from scratch, measure the steady state
+            broadphase->update(scene.aabbs.data(), count);
+
+            double time = measure([&]() {
+                scene.move();
+                broadphase->update(scene.aabbs.data(), count);
+                pairs.clear();
+                broadphase->findPairs(pairs);
+            }, 1.0);
+
+            double allPairs = (double)count * (count - 1) / 2.0;
+
+            printf("%18s %10u %14.3f %14.1f %12u %16.2e\n", broadphase->getName(), count,
+                   time * 1e3, time / count * 1e9, (unsigned int)pairs.size(), pairs.size() / allPairs);
+
+            if (count <= 10000) {
+                unsigned int expected = bruteForcePairCount(scene);
+                if (expected != pairs.size())
+                    printf("    MISMATCH: brute force finds %u pairs\n", expected);
+            }
+
+            delete broadphase;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,139 @@
+// hot paths of a step, each timed on its own for several scene sizes: corner points, integration,
+// world inertia tensors, the narrowphase and a full step, written as google benchmark json for the ci dashboards
+//
+// usage: HotPathBench [body counts...], json on stdout, a readable table on stderr
+//
+// host build: the HotPathBench target of the host cmake build (app/CMakeLists.txt)
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <stdlib.h>
+
+#include <vector>
+
+#include "BenchUtils.h"
+
+#include "BodyStorage.h"
+#include "ContactCache.h"
+#include "Physics.h"
+
+using namespace glm;
+using namespace std;
+
+static const double DT = 1.0 / 60.0;
+// frames of the timed drop, the pile forms and starts to settle within them
+static const unsigned int DROP_FRAMES = 120;
+
+static JsonReport report;
+
+static void add(const string& name, unsigned int bodyCount, const Measurement& measurement) {
+
+    string fullName = name + "/" + to_string(bodyCount);
+    report.add(fullName, measurement, bodyCount);
+
+    fprintf(stderr, "%-44s %12.1f ns %12.1f ns/body %10u iterations\n", fullName.c_str(), measurement.realTime * 1e9,
+            measurement.realTime * 1e9 / bodyCount, measurement.iterations);
+}
+
+// spinning bodies spread out in a lattice, nothing touches so only the per body passes are measured
+static void fillBodies(BodyStorage& bodies, unsigned int bodyCount) {
+
+    bodies.reserve(bodyCount);
+
+    for (unsigned int index = 0; index < bodyCount; index++) {
+        vec3 position = vec3((float)(index % 16), (float)((index / 16) % 16), (float)(index / 256)) * 2.0f;
+        unsigned int body = bodies.add(position, angleAxis(0.1f * (float)(index % 13), normalize(vec3(1, 2, 3))),
+                                       vec3(1.0f), 1.0f);
+        bodies.setVelocity(body, vec3(0.01f, 0, 0), vec3(0.3f + (float)(index % 7) * 0.1f, -0.2f, 0.1f));
+    }
+}
+
+static void benchBodies(unsigned int bodyCount) {
+
+    BodyStorage bodies;
+    fillBodies(bodies, bodyCount);
+
+    vector<vec3> points(8);
+
+    // the corners and tensors are cached until the body moves, integrating first makes every call recompute them
+    add("BodyStorage::calcPoints", bodyCount, measureWithSetup([&]() {
+        bodies.integrate(DT);
+    }, [&]() {
+        for (unsigned int index = 0; index < bodyCount; index++)
+            bodies.calcPoints(index, points.data());
+        doNotOptimize(points[0]);
+    }));
+
+    add("BodyStorage::getWorldInvInertiaTensor", bodyCount, measureWithSetup([&]() {
+        bodies.integrate(DT);
+    }, [&]() {
+        vec3 sum = vec3(0.0f);
+        for (unsigned int index = 0; index < bodyCount; index++)
+            sum += bodies.getWorldInvInertiaTensor(index)[0];
+        doNotOptimize(sum);
+    }));
+
+    add("BodyStorage::integrate", bodyCount, measureWithSetup([]() {
+    }, [&]() {
+        bodies.integrate(DT);
+    }));
+}
+
+static void benchScene(unsigned int bodyCount) {
+
+    Physics& physics = Physics::getInstance();
+
+    // one thread, the dashboards track the work done, not the core count of the runner
+    physics.setThreadCount(1);
+    physics.initialize();
+    physics.spawnCubes(bodyCount, 1.0f);
+
+    // the lattice has to replace the default cube, a box left inside it would make the drop time the push-out
+    if (physics.getWorld().getBodyCount() != bodyCount) {
+        fprintf(stderr, "%u bodies in the scene instead of the %u of the lattice\n",
+                physics.getWorld().getBodyCount(), bodyCount);
+        exit(1);
+    }
+
+    // a fresh drop every time into an empty box, so every run steps through the same frames
+    add("Physics::step", bodyCount, measureCount([&]() {
+        physics.step(DT);
+    }, DROP_FRAMES));
+
+    const Cube* walls = physics.getWalls();
+    Aabb wallsBounds = { walls->getLeftBottomNear(), walls->getRightTopFar() };
+
+    vector<BodyPair> pairs = physics.getPairs();
+    const BodyStorage& bodies = physics.getWorld().getBodies();
+
+    // the pairs of the last frame, clearing drops the manifolds that sleeping pairs would otherwise reuse
+    ContactCache contacts;
+    add("ContactCache::update", bodyCount, measureWithSetup([&]() {
+        contacts.clear();
+    }, [&]() {
+        contacts.update(pairs, bodies, wallsBounds);
+        doNotOptimize(contacts.getManifolds().size());
+    }));
+
+    physics.finalize();
+}
+
+int main(int argc, char** argv) {
+
+    vector<unsigned int> bodyCounts;
+    for (int index = 1; index < argc; index++)
+        bodyCounts.push_back((unsigned int) atoi(argv[index]));
+
+    if (bodyCounts.empty())
+        bodyCounts = { 64, 512, 4096 };
+
+    for (unsigned int bodyCount : bodyCounts) {
+        benchBodies(bodyCount);
+        benchScene(bodyCount);
+    }
+
+    report.write(stdout, argv[0]);
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+// parallel island solving: solver time per step for 1, 2, 4 and 8 threads over a field of separate stacks,
+// and a hash of the final positions that has to be the same for every thread count
+//
+// host build: the IslandBench target of the host cmake build (app/CMakeLists.txt)
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <string.h>
+
+#include <vector>
+
+#include "BenchUtils.h"
+
+#include "BodyStorage.h"
+#include "Broadphase.h"
+#include "ContactCache.h"
+#include "ContactSolver.h"
+#include "Islands.h"
+#include "JobSystem.h"
+
+using namespace glm;
+using namespace std;
+
+static const unsigned int STACKS_PER_SIDE = 24;
+static const unsigned int STACK_HEIGHT = 4;
+static const float BOX_SIZE = 0.5f;
+static const float SPACING = 1.5f;
+
+static const double DT = 1.0 / 60.0;
+static const unsigned int STEPS = 240;
+
+// min z wall
+static const unsigned int FLOOR = ContactManifold::FIRST_WALL + 4;
+
+struct Result {
+    double solverTime;
+    unsigned long long hash;
+    unsigned int islandCount;
+};
+
+static Result run(unsigned int threadCount) {
+
+    BodyStorage bodies;
+
+    // slightly twisted, so the stacks keep working instead of settling at once
+    for (unsigned int x = 0; x < STACKS_PER_SIDE; x++) {
+        for (unsigned int y = 0; y < STACKS_PER_SIDE; y++) {
+            for (unsigned int level = 0; level < STACK_HEIGHT; level++) {
+                vec3 position = vec3(x * SPACING, y * SPACING, BOX_SIZE * (level + 0.5f) + 0.01f * level);
+                quat orientation = angleAxis(0.05f * (float)((x + y + level) % 5), vec3(0, 0, 1));
+                bodies.add(position, orientation, vec3(BOX_SIZE), 1.0f);
+            }
+        }
+    }
+
+    float side = STACKS_PER_SIDE * SPACING;
+    Aabb bounds = { vec3(-SPACING, -SPACING, 0), vec3(side, side, STACK_HEIGHT * BOX_SIZE * 2.0f) };
+
+    Broadphase* broadphase = createBroadphase(UniformGrid, bounds);
+    ContactCache contacts;
+    Islands islands;
+    JobSystem jobs(threadCount);
+    ContactSolver solver;
+    solver.setJobSystem(&jobs);
+
+    vector<Aabb> aabbs;
+    vector<BodyPair> pairs;
+
+    vec3 gravity = vec3(0, 0, -9.8f);
+
+    Result result;
+    result.solverTime = 0;
+
+    for (unsigned int step = 0; step < STEPS; step++) {
+
+        bodies.applyGravity(gravity, DT);
+
+        aabbs.resize(bodies.size());
+        bodies.calcAabbs(aabbs.data());
+        broadphase->update(aabbs.data(), bodies.size());
+        pairs.clear();
+        broadphase->findPairs(pairs);
+
+        for (unsigned int index = 0; index < bodies.size(); index++)
+            if (aabbs[index].min.z < bounds.min.z + 0.05f)
+                pairs.push_back({ index, FLOOR });
+
+        contacts.update(pairs, bodies, bounds);
+
+        // no sleeping, every island stays in the solver
+        vector<ContactManifold>& manifolds = contacts.getManifolds();
+        islands.build(manifolds, bodies);
+
+        double start = getTime();
+        solver.solveVelocities(manifolds, islands.getAwakeManifolds(), islands.getAwakeGroupOffsets(), bodies, (float)DT);
+        double velocityEnd = getTime();
+
+        bodies.integrate(DT);
+
+        double positionStart = getTime();
+        solver.solvePositions(manifolds, bodies);
+        result.solverTime += (velocityEnd - start) + (getTime() - positionStart);
+    }
+
+    result.solverTime /= STEPS;
+    result.islandCount = islands.getIslandCount();
+
+    // FNV-1a over the raw position bits
+    result.hash = 14695981039346656037ULL;
+    for (unsigned int index = 0; index < bodies.size(); index++) {
+        vec3 position = bodies.getPosition(index);
+        unsigned char bytes[sizeof(position)];
+        memcpy(bytes, &position, sizeof(position));
+        for (unsigned char byte : bytes)
+            result.hash = (result.hash ^ byte) * 1099511628211ULL;
+    }
+
+    delete broadphase;
+
+    return result;
+}
+
+int main() {
+
+    const unsigned int THREAD_COUNTS[] = { 1, 2, 4, 8 };
+
+    printf("%u stacks of %u boxes, %u cores\n", STACKS_PER_SIDE * STACKS_PER_SIDE, STACK_HEIGHT,
+           JobSystem::getCoreCount());
+    printf("%8s %10s %14s %10s %18s\n", "threads", "islands", "solver ms", "speedup", "position hash");
+
+    double baseTime = 0;
+    unsigned long long baseHash = 0;
+
+    for (unsigned int threadCount : THREAD_COUNTS) {
+
+        Result result = run(threadCount);
+        if (threadCount == 1) {
+            baseTime = result.solverTime;
+            baseHash = result.hash;
+        }
+
+        printf("%8u %10u %14.3f %10.2f %18llx%s\n", threadCount, result.islandCount, result.solverTime * 1e3,
+               baseTime / result.solverTime, result.hash, result.hash == baseHash ? "" : " MISMATCH");
+    }
+
+    return 0;
+}
@@ -0,0 +1,150 @@
+// integration kernels: throughput per instruction set and deviation from the scalar path
+//
+// host build: the KernelBench target of the host cmake build (app/CMakeLists.txt)
+
+#include <math.h>
+
+#include <algorithm>
+
+#include "BenchUtils.h"
+
+#include "AlignedArray.h"
+#include "IntegrationKernel.h"
+
+using namespace std;
+
+struct KernelBodies {
+    AlignedArray<float> arrays[13];
+
+    KernelBodies(unsigned int count) {
+
+        for (AlignedArray<float>& array : arrays)
+            array.resize(count);
+
+        for (unsigned int index = 0; index < count; index++) {
+
+            float angle = (float)index * 0.37f;
+
+            arrays[0][index] = (float)(index % 97) * 0.1f;
+            arrays[1][index] = (float)(index % 89) * 0.1f;
+            arrays[2][index] = (float)(index % 83) * 0.1f;
+
+            // unit quaternion around a varying axis
+            float s = sinf(angle * 0.5f);
+            arrays[3][index] = s * 0.48f;
+            arrays[4][index] = s * 0.6f;
+            arrays[5][index] = s * 0.64f;
+            arrays[6][index] = cosf(angle * 0.5f);
+
+            arrays[7][index] = 0.5f;
+            arrays[8][index] = -0.25f;
+            arrays[9][index] = 1.0f;
+
+            arrays[10][index] = 2.0f + (float)(index % 7);
+            arrays[11][index] = -1.5f;
+            arrays[12][index] = (float)(index % 5) * 0.8f;
+        }
+    }
+
+    IntegrationStreams getStreams() {
+
+        IntegrationStreams streams = {
+                arrays[0].data(), arrays[1].data(), arrays[2].data(),
+                arrays[3].data(), arrays[4].data(), arrays[5].data(), arrays[6].data(),
+                arrays[7].data(), arrays[8].data(), arrays[9].data(),
+                arrays[10].data(), arrays[11].data(), arrays[12].data(),
+                arrays[0].size()
+        };
+
+        return streams;
+    }
+};
+
+static void step(const IntegrationKernel& kernel, const IntegrationStreams& streams) {
+
+    const float DT = 1.0f / 60.0f;
+
+    kernel.addLinearVelocity(streams, 0, 0, -9.8f * DT);
+    kernel.integrateTransforms(streams, DT);
+    kernel.scaleVelocities(streams, 1.0f - DT * 0.1f);
+}
+
+int main() {
+
+    const IntegrationKernel* kernels[4];
+    unsigned int kernelCount = getAvailableIntegrationKernels(kernels, 4);
+
+    printf("selected kernel: %s\n\n", getIntegrationKernel().name);
+
+    // throughput
+
+    unsigned int counts[] = { 1000, 10000, 100000 };
+
+    printf("%10s", "bodies");
+    for (unsigned int kernelIndex = 0; kernelIndex < kernelCount; kernelIndex++)
+        printf(" %12s", kernels[kernelIndex]->name);
+    printf("   (ns per body per step)\n");
+
+    for (unsigned int count : counts) {
+
+        printf("%10u", count);
+
+        for (unsigned int kernelIndex = 0; kernelIndex < kernelCount; kernelIndex++) {
+
+            KernelBodies bodies(count);
+            IntegrationStreams streams = bodies.getStreams();
+
+            double time = measure([&]() {
+                step(*kernels[kernelIndex], streams);
+                doNotOptimize(streams.positionX[0]);
+            });
+
+            printf(" %12.2f", time / count * 1e9);
+        }
+
+        printf("\n");
+    }
+
+    // deviation from the scalar kernel
+
+    const unsigned int COUNT = 1003;
+    const unsigned int STEP_COUNTS[] = { 1, 1000 };
+
+    printf("\n%10s %8s %16s %16s %16s\n", "kernel", "steps", "max |dp|", "max |dq|", "max |1-|q||");
+
+    for (unsigned int kernelIndex = 1; kernelIndex < kernelCount; kernelIndex++) {
+        for (unsigned int stepCount : STEP_COUNTS) {
+
+            KernelBodies reference(COUNT), bodies(COUNT);
+            IntegrationStreams referenceStreams = reference.getStreams(), streams = bodies.getStreams();
+
+            for (unsigned int stepIndex = 0; stepIndex < stepCount; stepIndex++) {
+                step(*kernels[0], referenceStreams);
+                step(*kernels[kernelIndex], streams);
+            }
+
+            float maxPositionError = 0, maxOrientationError = 0, maxNormError = 0;
+
+            for (unsigned int index = 0; index < COUNT; index++) {
+
+                for (unsigned int arrayIndex = 0; arrayIndex < 3; arrayIndex++)
+                    maxPositionError = max(maxPositionError,
+                            fabsf(bodies.arrays[arrayIndex][index] - reference.arrays[arrayIndex][index]));
+
+                float lengthSq = 0;
+                for (unsigned int arrayIndex = 3; arrayIndex < 7; arrayIndex++) {
+                    float q = bodies.arrays[arrayIndex][index];
+                    maxOrientationError = max(maxOrientationError, fabsf(q - reference.arrays[arrayIndex][index]));
+                    lengthSq += q * q;
+                }
+
+                maxNormError = max(maxNormError, fabsf(1.0f - sqrtf(lengthSq)));
+            }
+
+            printf("%10s %8u %16g %16g %16g\n", kernels[kernelIndex]->name, stepCount,
+                   maxPositionError, maxOrientationError, maxNormError);
+        }
+    }
+
+    return 0;
+}
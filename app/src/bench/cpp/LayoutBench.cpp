@@ -0,0 +1,125 @@
+// AoS vs SoA body storage: cost of the gravity, integration and damping passes
+//
+// host build: the LayoutBench target of the host cmake build (app/CMakeLists.txt)
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <vector>
+
+#include "BenchUtils.h"
+
+#include "BodyStorage.h"
+#include "Cube.h"
+
+using namespace glm;
+using namespace std;
+
+// the layout the bodies had before BodyStorage: a heap Cube plus a heap PhysicsData pointing at it
+struct AosPhysicsData {
+    Cube* cube;
+
+    vec3 linearVelocity, angularVelocity;
+
+    float invMass;
+    mat3 localInvInertiaTensor, worldInvInertiaTensor;
+
+    AosPhysicsData(Cube* cube, float mass) : cube(cube), linearVelocity(0), angularVelocity(0) {
+
+        vec3 sizeSq = cube->getSize() * cube->getSize();
+
+        vec3 inertia = {
+            mass / 12.0f * (sizeSq.y + sizeSq.z),
+            mass / 12.0f * (sizeSq.x + sizeSq.z),
+            mass / 12.0f * (sizeSq.x + sizeSq.y)
+        };
+
+        invMass = 1.0f / mass;
+        localInvInertiaTensor = scale(mat4(1.0f), 1.0f / inertia);
+
+        updateInertiaTensor();
+    }
+
+    void updateInertiaTensor() {
+        mat3 rotation = cube->getRotation();
+        worldInvInertiaTensor = rotation * localInvInertiaTensor * transpose(rotation);
+    }
+
+    void applyGravity(vec3 gravity, double dt) {
+        linearVelocity += gravity * (float)dt;
+    }
+
+    void integrate(double dt) {
+        cube->integrateTransforms(linearVelocity * (float)dt, angularVelocity * (float)dt);
+        updateInertiaTensor();
+    }
+
+    void applyDamping(double dt, float damping) {
+        float m = 1.0f - (float)dt * damping;
+        linearVelocity *= m;
+        angularVelocity *= m;
+    }
+};
+
+static vec3 bodyPosition(unsigned int index) {
+    return vec3((float)(index % 97), (float)(index % 89), (float)(index % 83)) * 0.1f;
+}
+
+static vec3 bodySpin(unsigned int index) {
+    return vec3(0.3f + (float)(index % 7) * 0.1f, -0.2f, 0.1f * (float)(index % 5));
+}
+
+int main() {
+
+    const double DT = 1.0 / 60.0;
+    const vec3 GRAVITY = vec3(0, 0, -9.8f);
+
+    unsigned int counts[] = { 1000, 10000, 100000 };
+
+    printf("%10s %16s %16s %10s\n", "bodies", "aos ns/body", "soa ns/body", "speedup");
+
+    for (unsigned int count : counts) {
+
+        vector<AosPhysicsData*> aosBodies;
+        for (unsigned int index = 0; index < count; index++) {
+            Cube* cube = new Cube(bodyPosition(index), quat(1, 0, 0, 0), vec3(1.0f));
+            aosBodies.push_back(new AosPhysicsData(cube, 1.0f));
+            aosBodies.back()->angularVelocity = bodySpin(index);
+        }
+
+        BodyStorage soaBodies;
+        soaBodies.reserve(count);
+        for (unsigned int index = 0; index < count; index++) {
+            soaBodies.add(bodyPosition(index), quat(1, 0, 0, 0), vec3(1.0f), 1.0f);
+            soaBodies.setVelocity(index, vec3(0), bodySpin(index));
+        }
+
+        double aosTime = measure([&]() {
+            for (AosPhysicsData* body : aosBodies)
+                body->applyGravity(GRAVITY, DT);
+            for (AosPhysicsData* body : aosBodies)
+                body->integrate(DT);
+            for (AosPhysicsData* body : aosBodies)
+                body->applyDamping(DT, 0.1f);
+            doNotOptimize(aosBodies[0]->cube->getPosition());
+        });
+
+        double soaTime = measure([&]() {
+            soaBodies.applyGravity(GRAVITY, DT);
+            soaBodies.integrate(DT);
+            soaBodies.applyDamping(DT, 0.1f);
+            doNotOptimize(soaBodies.getPosition(0));
+        });
+
+        printf("%10u %16.2f %16.2f %9.2fx\n", count,
+               aosTime / count * 1e9, soaTime / count * 1e9, aosTime / soaTime);
+
+        for (AosPhysicsData* body : aosBodies) {
+            delete body->cube;
+            delete body;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+// narrowphase: box-vs-box pairs per second for the configurations a pile produces
+//
+// host build: the NarrowphaseBench target of the host cmake build (app/CMakeLists.txt)
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <stdlib.h>
+
+#include <vector>
+
+#include "BenchUtils.h"
+
+#include "Narrowphase.h"
+
+using namespace glm;
+using namespace std;
+
+struct BoxPair {
+    OrientedBox a, b;
+};
+
+static float random(float min, float max) {
+    return min + (max - min) * (float)rand() / (float)RAND_MAX;
+}
+
+static mat3 randomRotation() {
+    vec3 axis = normalize(vec3(random(-1, 1), random(-1, 1), random(-1, 1)) + vec3(0, 0, 0.001f));
+    return mat3(rotate(mat4(1.f), random(0, 6.2832f), axis));
+}
+
+static vec3 randomHalfSize() {
+    return vec3(random(0.3f, 0.6f), random(0.3f, 0.6f), random(0.3f, 0.6f));
+}
+
+// b rests on top of a, slightly sunk in and twisted around the vertical: face contacts with clipping
+static BoxPair makeResting() {
+
+    BoxPair pair;
+    pair.a = { vec3(0), mat3(1.0f), randomHalfSize() };
+    pair.b.halfSize = randomHalfSize();
+    pair.b.rotation = mat3(rotate(mat4(1.f), random(0, 6.2832f), vec3(0, 0, 1)));
+    pair.b.center = vec3(random(-0.3f, 0.3f), random(-0.3f, 0.3f), pair.a.halfSize.z + pair.b.halfSize.z - 0.01f);
+
+    return pair;
+}
+
+// arbitrary orientations with overlapping bounding spheres, what the broadphase hands over in a heap
+static BoxPair makeRandom() {
+
+    BoxPair pair;
+    pair.a = { vec3(0), randomRotation(), randomHalfSize() };
+    pair.b = { vec3(random(-1, 1), random(-1, 1), random(-1, 1)), randomRotation(), randomHalfSize() };
+
+    return pair;
+}
+
+static void run(const char* name, BoxPair (*make)()) {
+
+    const unsigned int COUNT = 4096;
+
+    srand(1);
+
+    vector<BoxPair> pairs;
+    for (unsigned int index = 0; index < COUNT; index++)
+        pairs.push_back(make());
+
+    vector<ContactManifold> manifolds(COUNT);
+    unsigned int hits = 0, points = 0;
+
+    double time = measure([&]() {
+
+        hits = 0;
+        points = 0;
+
+        for (unsigned int index = 0; index < COUNT; index++) {
+            if (collideBoxes(pairs[index].a, pairs[index].b, manifolds[index])) {
+                hits++;
+                points += manifolds[index].pointCount;
+            }
+        }
+
+        doNotOptimize(manifolds[COUNT - 1]);
+    }, 1.0);
+
+    printf("%10s %16.2f %12.1f %10.1f%% %16.2f\n", name, COUNT / time * 1e-6, time / COUNT * 1e9,
+           100.0 * hits / COUNT, hits > 0 ? (double)points / hits : 0.0);
+}
+
+int main() {
+
+    printf("%10s %16s %12s %11s %16s\n", "pairs", "M pairs per sec", "ns per pair", "touching", "points per hit");
+
+    run("resting", makeResting);
+    run("random", makeRandom);
+
+    return 0;
+}
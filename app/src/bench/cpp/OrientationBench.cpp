@@ -0,0 +1,181 @@
+// quaternion-native orientation: integration cost and long-run drift against
+// the previous mat3 storage (quat_cast -> integrate -> mat3_cast and eager inertia every step)
+//
+// host build: the OrientationBench target of the host cmake build (app/CMakeLists.txt)
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <math.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "BenchUtils.h"
+
+#include "BodyStorage.h"
+
+using namespace glm;
+using namespace std;
+
+// what every integrated body paid before: mat3 storage and eager derived data
+struct EagerBody {
+    vec3 position;
+    mat3 rotation;
+    vec3 size;
+    vec3 points[8];
+
+    vec3 linearVelocity, angularVelocity;
+    mat3 localInvInertiaTensor, worldInvInertiaTensor;
+
+    void calcPoints() {
+
+        const vec3 CUBE_POINTS[8] = {
+                {  0.50f,  0.50f,  0.50f }, {  0.50f, -0.50f,  0.50f },
+                {  0.50f,  0.50f, -0.50f }, {  0.50f, -0.50f, -0.50f },
+                { -0.50f,  0.50f,  0.50f }, { -0.50f, -0.50f,  0.50f },
+                { -0.50f,  0.50f, -0.50f }, { -0.50f, -0.50f, -0.50f },
+        };
+
+        for (unsigned int pointIndex = 0; pointIndex < 8; pointIndex++)
+            points[pointIndex] = (rotation * (CUBE_POINTS[pointIndex] * size)) + position;
+    }
+
+    void integrate(float dt) {
+
+        position += linearVelocity * dt;
+
+        vec3 rotationDelta = angularVelocity * dt;
+        quat q = quat_cast(rotation);
+        q += (quat(0, rotationDelta.x, rotationDelta.y, rotationDelta.z) * q) * 0.5f;
+        rotation = mat3_cast(normalize(q));
+
+        calcPoints();
+
+        worldInvInertiaTensor = rotation * localInvInertiaTensor * transpose(rotation);
+    }
+};
+
+static float orthonormalityError(const mat3& rotation) {
+
+    mat3 product = transpose(rotation) * rotation;
+
+    float error = 0;
+    for (unsigned int column = 0; column < 3; column++)
+        for (unsigned int row = 0; row < 3; row++)
+            error = std::max(error, fabsf(product[column][row] - (column == row ? 1.0f : 0.0f)));
+
+    return error;
+}
+
+// a unit cube has the same inertia around every axis, so the rotational energy computed
+// through the derived world tensor only drifts when the rotation stops being orthonormal
+static float rotationalEnergy(const mat3& worldInvInertiaTensor, vec3 angularVelocity) {
+
+    // off-diagonal terms vanish for an isotropic body
+    float invInertia = (worldInvInertiaTensor[0][0] + worldInvInertiaTensor[1][1] + worldInvInertiaTensor[2][2]) / 3.0f;
+
+    return 0.5f * dot(angularVelocity, angularVelocity) / invInertia;
+}
+
+int main() {
+
+    const float DT = 1.0f / 60.0f;
+    const vec3 SPIN = vec3(1.3f, -0.7f, 2.1f);
+
+    // cost per integrated body
+
+    unsigned int counts[] = { 1000, 10000, 100000 };
+
+    printf("%10s %16s %16s %16s   (ns per body per step)\n", "bodies", "eager mat3", "quat, no reads", "quat, all reads");
+
+    for (unsigned int count : counts) {
+
+        vector<EagerBody> eagerBodies(count);
+        BodyStorage bodies;
+        bodies.reserve(count);
+
+        for (unsigned int index = 0; index < count; index++) {
+
+            EagerBody& body = eagerBodies[index];
+            body.position = vec3((float)index);
+            body.rotation = mat3(1.0f);
+            body.size = vec3(1.0f);
+            body.linearVelocity = vec3(0, 0, -1);
+            body.angularVelocity = SPIN;
+            body.localInvInertiaTensor = mat3(6.0f);
+
+            bodies.add(vec3((float)index), quat(1, 0, 0, 0), vec3(1.0f), 1.0f);
+            bodies.setVelocity(index, vec3(0, 0, -1), SPIN);
+        }
+
+        double eagerTime = measure([&]() {
+            for (EagerBody& body : eagerBodies)
+                body.integrate(DT);
+            doNotOptimize(eagerBodies[0].points[0]);
+        });
+
+        double lazyTime = measure([&]() {
+            bodies.integrate(DT);
+            doNotOptimize(bodies.getPosition(0));
+        });
+
+        // a consumer that needs every rotation and inertia tensor, the worst case for laziness
+        double lazyReadTime = measure([&]() {
+            bodies.integrate(DT);
+            vec3 points[8];
+            for (unsigned int index = 0; index < count; index++) {
+                bodies.calcPoints(index, points);
+                doNotOptimize(bodies.getWorldInvInertiaTensor(index));
+            }
+            doNotOptimize(points[0]);
+        });
+
+        printf("%10u %16.2f %16.2f %16.2f\n", count,
+               eagerTime / count * 1e9, lazyTime / count * 1e9, lazyReadTime / count * 1e9);
+    }
+
+    // long-run drift of a spinning unit cube
+
+    const unsigned int STEP_COUNT = 1000000;
+
+    EagerBody eager;
+    eager.position = vec3(0);
+    eager.rotation = mat3(1.0f);
+    eager.size = vec3(1.0f);
+    eager.linearVelocity = vec3(0);
+    eager.angularVelocity = SPIN;
+    eager.localInvInertiaTensor = mat3(6.0f);
+    eager.worldInvInertiaTensor = mat3(6.0f);
+
+    BodyStorage single;
+    single.add(vec3(0), quat(1, 0, 0, 0), vec3(1.0f), 1.0f);
+    single.setVelocity(0, vec3(0), SPIN);
+
+    float initialEnergy = rotationalEnergy(mat3(6.0f), SPIN);
+
+    float eagerOrthonormality = 0, quatOrthonormality = 0, eagerEnergy = 0, quatEnergy = 0;
+
+    for (unsigned int stepIndex = 0; stepIndex < STEP_COUNT; stepIndex++) {
+
+        eager.integrate(DT);
+        single.integrate(DT);
+
+        if (stepIndex % 1000 == 999) {
+
+            eagerOrthonormality = std::max(eagerOrthonormality, orthonormalityError(eager.rotation));
+            quatOrthonormality = std::max(quatOrthonormality, orthonormalityError(single.getRotation(0)));
+
+            eagerEnergy = std::max(eagerEnergy, fabsf(rotationalEnergy(eager.worldInvInertiaTensor, SPIN) - initialEnergy));
+            quatEnergy = std::max(quatEnergy, fabsf(rotationalEnergy(single.getWorldInvInertiaTensor(0), SPIN) - initialEnergy));
+        }
+    }
+
+    printf("\n%u steps of a spinning unit cube\n", STEP_COUNT);
+    printf("%16s %24s %24s\n", "", "max |R^T R - I|", "max relative energy drift");
+    printf("%16s %24g %24g\n", "eager mat3", eagerOrthonormality, eagerEnergy / initialEnergy);
+    printf("%16s %24g %24g\n", "quat", quatOrthonormality, quatEnergy / initialEnergy);
+
+    return 0;
+}
@@ -0,0 +1,162 @@
+// coloured solver: solver time per step for a single 10k box pile on 1 to 8 threads,
+// and a hash of the final positions that has to be the same for every thread count
+//
+// host build: the PileBench target of the host cmake build (app/CMakeLists.txt)
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <string.h>
+
+#include <vector>
+
+#include "BenchUtils.h"
+
+#include "BodyStorage.h"
+#include "Broadphase.h"
+#include "ContactCache.h"
+#include "ContactSolver.h"
+#include "Islands.h"
+#include "JobSystem.h"
+
+using namespace glm;
+using namespace std;
+
+// 22 x 22 x 21 boxes, a bit over 10k
+static const unsigned int PILE_SIDE = 22;
+static const unsigned int PILE_HEIGHT = 21;
+static const float BOX_SIZE = 0.2f;
+
+static const double DT = 1.0 / 60.0;
+// the pile settles into one island before measuring
+static const unsigned int SETTLE_STEPS = 10;
+static const unsigned int MEASURE_STEPS = 20;
+
+struct Result {
+    double solverTime;
+    unsigned long long hash;
+    unsigned int largestIsland;
+    unsigned int colourCount;
+};
+
+static Result run(unsigned int threadCount) {
+
+    BodyStorage bodies;
+
+    // a touching lattice, every other layer shifted a little so the pile does not stay a perfect grid
+    for (unsigned int z = 0; z < PILE_HEIGHT; z++) {
+        float shift = (z % 2) * BOX_SIZE * 0.25f;
+        for (unsigned int y = 0; y < PILE_SIDE; y++)
+            for (unsigned int x = 0; x < PILE_SIDE; x++)
+                bodies.add(vec3(shift + x * BOX_SIZE, shift + y * BOX_SIZE, (z + 0.5f) * BOX_SIZE * 0.99f),
+                           quat(1, 0, 0, 0), vec3(BOX_SIZE), 1.0f);
+    }
+
+    float side = (PILE_SIDE + 1) * BOX_SIZE;
+    Aabb bounds = { vec3(-BOX_SIZE, -BOX_SIZE, 0), vec3(side, side, PILE_HEIGHT * BOX_SIZE * 1.5f) };
+
+    Broadphase* broadphase = createBroadphase(UniformGrid, bounds);
+    ContactCache contacts;
+    Islands islands;
+    JobSystem jobs(threadCount);
+    ContactSolver solver;
+    solver.setJobSystem(&jobs);
+
+    vector<Aabb> aabbs;
+    vector<BodyPair> pairs;
+
+    vec3 gravity = vec3(0, 0, -9.8f);
+    Aabb inner = bounds.expand(-0.05f);
+
+    Result result;
+    result.solverTime = 0;
+
+    for (unsigned int step = 0; step < SETTLE_STEPS + MEASURE_STEPS; step++) {
+
+        bodies.applyGravity(gravity, DT);
+
+        aabbs.resize(bodies.size());
+        bodies.calcAabbs(aabbs.data());
+        broadphase->update(aabbs.data(), bodies.size());
+        pairs.clear();
+        broadphase->findPairs(pairs);
+
+        for (unsigned int index = 0; index < bodies.size(); index++) {
+            for (unsigned int axis = 0; axis < 3; axis++) {
+                if (aabbs[index].min[axis] < inner.min[axis])
+                    pairs.push_back({ index, ContactManifold::FIRST_WALL + axis * 2 });
+                if (aabbs[index].max[axis] > inner.max[axis])
+                    pairs.push_back({ index, ContactManifold::FIRST_WALL + axis * 2 + 1 });
+            }
+        }
+
+        contacts.update(pairs, bodies, bounds);
+
+        // no sleeping, the whole pile stays in the solver
+        vector<ContactManifold>& manifolds = contacts.getManifolds();
+        islands.build(manifolds, bodies);
+
+        const vector<unsigned int>& groups = islands.getAwakeGroupOffsets();
+
+        double start = getTime();
+        solver.solveVelocities(manifolds, islands.getAwakeManifolds(), groups, bodies, (float)DT);
+        double velocityEnd = getTime();
+
+        bodies.integrate(DT);
+
+        double positionStart = getTime();
+        solver.solvePositions(manifolds, bodies);
+        double positionEnd = getTime();
+
+        if (step >= SETTLE_STEPS)
+            result.solverTime += (velocityEnd - start) + (positionEnd - positionStart);
+
+        result.largestIsland = 0;
+        for (unsigned int group = 0; group + 1 < groups.size(); group++)
+            result.largestIsland = std::max(result.largestIsland, groups[group + 1] - groups[group]);
+    }
+
+    result.solverTime /= MEASURE_STEPS;
+    result.colourCount = solver.getColourCount();
+
+    // FNV-1a over the raw position bits
+    result.hash = 14695981039346656037ULL;
+    for (unsigned int index = 0; index < bodies.size(); index++) {
+        vec3 position = bodies.getPosition(index);
+        unsigned char bytes[sizeof(position)];
+        memcpy(bytes, &position, sizeof(position));
+        for (unsigned char byte : bytes)
+            result.hash = (result.hash ^ byte) * 1099511628211ULL;
+    }
+
+    delete broadphase;
+
+    return result;
+}
+
+int main() {
+
+    const unsigned int THREAD_COUNTS[] = { 1, 2, 4, 8 };
+
+    printf("pile of %u boxes, %u cores\n", PILE_SIDE * PILE_SIDE * PILE_HEIGHT, JobSystem::getCoreCount());
+    printf("%8s %16s %8s %14s %10s %18s\n", "threads", "largest island", "colours", "solver ms", "speedup",
+           "position hash");
+
+    double baseTime = 0;
+    unsigned long long baseHash = 0;
+
+    for (unsigned int threadCount : THREAD_COUNTS) {
+
+        Result result = run(threadCount);
+        if (threadCount == 1) {
+            baseTime = result.solverTime;
+            baseHash = result.hash;
+        }
+
+        printf("%8u %16u %8u %14.2f %10.2f %18llx%s\n", threadCount, result.largestIsland, result.colourCount,
+               result.solverTime * 1e3, baseTime / result.solverTime, result.hash,
+               result.hash == baseHash ? "" : " MISMATCH");
+    }
+
+    return 0;
+}
@@ -0,0 +1,135 @@
+// startup cost of restoring a saved world: the snapshot file read with fread into a buffer versus mapped with mmap,
+// both with the file in the page cache (warm) and evicted from it (cold), plus the restore from memory alone,
+// which is the floor either way, written as google benchmark json
+//
+// usage: SnapshotBench [body counts...] (10000 and 100000 by default), json on stdout, a readable table on stderr
+//
+// host build: the SnapshotBench target of the host cmake build (app/CMakeLists.txt)
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "BenchUtils.h"
+
+#include "MappedFile.h"
+#include "Physics.h"
+#include "StateStorage.h"
+
+using namespace std;
+
+static const string SNAPSHOT_FILE_NAME = "snapshot.bin";
+
+static JsonReport report;
+
+static void add(const string& name, unsigned int bodyCount, const Measurement& measurement) {
+
+    string fullName = name + "/" + to_string(bodyCount);
+    report.add(fullName, measurement, bodyCount);
+
+    fprintf(stderr, "%-28s %10.3f ms %8.1f ns/body %6u iterations\n", fullName.c_str(), measurement.realTime * 1e3,
+            measurement.realTime * 1e9 / bodyCount, measurement.iterations);
+}
+
+// synced first, dirty pages can't be dropped
+static void writeSnapshot(const string& fileName, const vector<unsigned char>& snapshot) {
+
+    int fileHandle = open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fileHandle < 0 || write(fileHandle, snapshot.data(), snapshot.size()) != (ssize_t) snapshot.size()) {
+        fprintf(stderr, "can't write %s\n", fileName.c_str());
+        exit(1);
+    }
+
+    fsync(fileHandle);
+    close(fileHandle);
+}
+
+// drops the file from the page cache, so the next read goes to the disk like on a cold start
+static void evict(const string& fileName) {
+
+    int fileHandle = open(fileName.c_str(), O_RDONLY);
+    if (fileHandle < 0)
+        return;
+
+    posix_fadvise(fileHandle, 0, 0, POSIX_FADV_DONTNEED);
+    close(fileHandle);
+}
+
+static void benchRestore(DirectoryStorage& storage, unsigned int bodyCount) {
+
+    Physics& physics = Physics::getInstance();
+
+    physics.initialize();
+    physics.spawnCubes(bodyCount, 1.0f);
+    // a short drop, so there are velocities and contacts to restore as well
+    physics.step(1.0 / 60.0);
+
+    vector<unsigned char> snapshot;
+    physics.saveSnapshot(snapshot);
+
+    string fileName = storage.getDirectory() + "/" + SNAPSHOT_FILE_NAME;
+    writeSnapshot(fileName, snapshot);
+
+    fprintf(stderr, "%u bodies, %u manifolds, %.2f MB snapshot\n", physics.getWorld().getBodyCount(),
+            (unsigned int) physics.getManifolds().size(), snapshot.size() / (1024.0 * 1024.0));
+
+    auto noSetup = [] () { };
+    auto coldSetup = [&] () { evict(fileName); };
+
+    auto restoreFromMemory = [&] () {
+        if (!physics.loadSnapshot(snapshot.data(), snapshot.size()))
+            exit(1);
+    };
+
+    auto restoreWithRead = [&] () {
+        vector<unsigned char> data;
+        if (!storage.loadBinaryFile(SNAPSHOT_FILE_NAME, data) || !physics.loadSnapshot(data.data(), data.size()))
+            exit(1);
+    };
+
+    auto restoreWithMap = [&] () {
+        MappedFile file;
+        if (!storage.mapBinaryFile(SNAPSHOT_FILE_NAME, file) || !physics.loadSnapshot(file.getData(), file.getSize()))
+            exit(1);
+    };
+
+    add("BM_RestoreFromMemory", bodyCount, measureWithSetup(noSetup, restoreFromMemory));
+    add("BM_RestoreRead/warm", bodyCount, measureWithSetup(noSetup, restoreWithRead));
+    add("BM_RestoreMap/warm", bodyCount, measureWithSetup(noSetup, restoreWithMap));
+    add("BM_RestoreRead/cold", bodyCount, measureWithSetup(coldSetup, restoreWithRead));
+    add("BM_RestoreMap/cold", bodyCount, measureWithSetup(coldSetup, restoreWithMap));
+
+    unlink(fileName.c_str());
+
+    physics.finalize();
+}
+
+int main(int argc, char** argv) {
+
+    vector<unsigned int> bodyCounts;
+    for (int arg = 1; arg < argc; arg++)
+        bodyCounts.push_back((unsigned int) atoi(argv[arg]));
+
+    if (bodyCounts.empty())
+        bodyCounts = { 10000, 100000 };
+
+    char directory[] = "/tmp/SnapshotBench.XXXXXX";
+    if (mkdtemp(directory) == nullptr) {
+        fprintf(stderr, "can't create a directory for the snapshots\n");
+        return 1;
+    }
+
+    DirectoryStorage storage(directory);
+
+    for (unsigned int bodyCount : bodyCounts)
+        benchRestore(storage, bodyCount);
+
+    rmdir(directory);
+
+    report.write(stdout, argv[0]);
+
+    return 0;
+}
@@ -0,0 +1,174 @@
+// resting stacks: velocity jitter left after settling for a given solver iteration count,
+// with and without warm starting, and the penetration left for a given position iteration count
+//
+// the stacks stand on the floor wall, so box-box and box-wall contacts both go through the solver
+//
+// host build: the StackBench target of the host cmake build (app/CMakeLists.txt)
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <math.h>
+
+#include <vector>
+
+#include "BenchUtils.h"
+
+#include "BodyStorage.h"
+#include "Broadphase.h"
+#include "ContactCache.h"
+#include "ContactSolver.h"
+
+using namespace glm;
+using namespace std;
+
+static const unsigned int COLUMNS = 4;
+static const float BOX_SIZE = 0.5f;
+
+// min z wall
+static const unsigned int FLOOR = ContactManifold::FIRST_WALL + 4;
+
+static const double DT = 1.0 / 60.0;
+static const unsigned int SETTLE_STEPS = 180;
+static const unsigned int MEASURE_STEPS = 120;
+
+struct Result {
+    // rms speed of the stacked boxes over the measured steps
+    double jitter;
+    // horizontal distance the top boxes slid from where they started
+    double drift;
+    // deepest contact in the last step
+    double penetration;
+    double stepTime;
+};
+
+static Result run(unsigned int height, unsigned int iterations, unsigned int positionIterations,
+                  bool warmStarting) {
+
+    BodyStorage bodies;
+
+    vector<vec3> tops;
+    for (unsigned int column = 0; column < COLUMNS; column++) {
+        for (unsigned int level = 0; level < height; level++) {
+            vec3 position = vec3(column * BOX_SIZE * 2.0f, 0, BOX_SIZE * (level + 0.5f));
+            bodies.add(position, quat(1, 0, 0, 0), vec3(BOX_SIZE), 1.0f);
+            if (level == height - 1)
+                tops.push_back(position);
+        }
+    }
+
+    Aabb bounds = { vec3(-10, -10, 0), vec3(10, 10, 10) };
+    Broadphase* broadphase = createBroadphase(UniformGrid, bounds);
+    ContactCache contacts;
+    ContactSolver solver;
+    solver.setVelocityIterations(iterations);
+    solver.setPositionIterations(positionIterations);
+    solver.setWarmStarting(warmStarting);
+
+    vector<Aabb> aabbs;
+    vector<BodyPair> pairs;
+    // every manifold, in cache order and as a single group: the stacks never sleep here
+    vector<unsigned int> order;
+    vector<unsigned int> groups(2, 0);
+
+    vec3 gravity = vec3(0, 0, -9.8f);
+
+    double jitterSum = 0;
+    double start = 0;
+
+    for (unsigned int step = 0; step < SETTLE_STEPS + MEASURE_STEPS; step++) {
+
+        if (step == SETTLE_STEPS)
+            start = getTime();
+
+        bodies.applyGravity(gravity, DT);
+
+        aabbs.resize(bodies.size());
+        bodies.calcAabbs(aabbs.data());
+        broadphase->update(aabbs.data(), bodies.size());
+        pairs.clear();
+        broadphase->findPairs(pairs);
+
+        for (unsigned int index = 0; index < bodies.size(); index++)
+            if (aabbs[index].min.z < bounds.min.z + 0.05f)
+                pairs.push_back({ index, FLOOR });
+
+        contacts.update(pairs, bodies, bounds);
+
+        order.resize(contacts.getManifolds().size());
+        for (unsigned int index = 0; index < order.size(); index++)
+            order[index] = index;
+        groups[1] = (unsigned int)order.size();
+
+        solver.solveVelocities(contacts.getManifolds(), order, groups, bodies, (float)DT);
+        bodies.integrate(DT);
+        solver.solvePositions(contacts.getManifolds(), bodies);
+
+        if (step >= SETTLE_STEPS) {
+            double sum = 0;
+            for (unsigned int index = 0; index < bodies.size(); index++) {
+                vec3 velocity = bodies.getLinearVelocity(index);
+                sum += dot(velocity, velocity);
+            }
+            jitterSum += sum / bodies.size();
+        }
+    }
+
+    Result result;
+    result.stepTime = (getTime() - start) / MEASURE_STEPS;
+    result.jitter = sqrt(jitterSum / MEASURE_STEPS);
+
+    result.drift = 0;
+    for (unsigned int column = 0; column < COLUMNS; column++) {
+        vec3 delta = bodies.getPosition(column * height + height - 1) - tops[column];
+        result.drift = std::max(result.drift, (double)sqrtf(delta.x * delta.x + delta.y * delta.y));
+    }
+
+    result.penetration = 0;
+    for (const ContactManifold& manifold : contacts.getManifolds())
+        for (unsigned int index = 0; index < manifold.pointCount; index++)
+            result.penetration = std::max(result.penetration, (double)manifold.points[index].penetration);
+
+    delete broadphase;
+
+    return result;
+}
+
+int main() {
+
+    const unsigned int HEIGHTS[] = { 4, 8 };
+    const unsigned int ITERATIONS[] = { 1, 2, 4, 8, 16, 32 };
+    const unsigned int POSITION_ITERATIONS[] = { 0, 1, 2, 3, 6 };
+    const unsigned int DEFAULT_POSITION_ITERATIONS = 3;
+
+    for (unsigned int height : HEIGHTS) {
+
+        printf("%u columns of %u boxes\n", COLUMNS, height);
+        printf("%11s %14s %14s %12s %14s %14s %12s\n", "iterations",
+               "cold jitter", "cold drift", "cold us", "warm jitter", "warm drift", "warm us");
+
+        for (unsigned int iterations : ITERATIONS) {
+
+            Result cold = run(height, iterations, DEFAULT_POSITION_ITERATIONS, false);
+            Result warm = run(height, iterations, DEFAULT_POSITION_ITERATIONS, true);
+
+            printf("%11u %14.2e %14.2e %12.1f %14.2e %14.2e %12.1f\n", iterations,
+                   cold.jitter, cold.drift, cold.stepTime * 1e6, warm.jitter, warm.drift, warm.stepTime * 1e6);
+        }
+    }
+
+    printf("8 velocity iterations, warm started\n");
+    printf("%11s %8s %16s %12s\n", "position it", "height", "penetration mm", "us");
+
+    for (unsigned int height : HEIGHTS) {
+        for (unsigned int positionIterations : POSITION_ITERATIONS) {
+
+            Result result = run(height, 8, positionIterations, true);
+
+            printf("%11u %8u %16.2f %12.1f\n", positionIterations, height,
+                   result.penetration * 1e3, result.stepTime * 1e6);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,141 @@
+// physics on the render thread vs on its own thread, with a renderer that waits for vsync every frame
+// and stalls on the gpu every so often: steps taken and dropped per second of real time
+//
+// host build: the ThreadBench target of the host cmake build (app/CMakeLists.txt)
+
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "BenchUtils.h"
+
+#include "Physics.h"
+#include "PhysicsThread.h"
+#include "RenderState.h"
+
+using namespace std;
+
+static const unsigned int BODY_COUNT = 256;
+static const double DURATION = 5.0;
+
+// a 120 Hz display, and a long gpu stall every half second
+static const double FRAME_TIME = 1.0 / 120.0;
+static const unsigned int STALL_PERIOD_FRAMES = 60;
+static const double STALL_TIME = 0.15;
+
+struct Result {
+    unsigned int steps;
+    unsigned int droppedSteps;
+    unsigned int frames;
+};
+
+// what the renderer's thread is blocked on: the swap waits for vsync, some frames for the gpu too
+static void present(unsigned int frame) {
+    usleep((useconds_t) timeToUSec(frame % STALL_PERIOD_FRAMES == STALL_PERIOD_FRAMES - 1 ? STALL_TIME : FRAME_TIME));
+}
+
+static void resetScene() {
+
+    Physics& physics = Physics::getInstance();
+
+    physics.finalize();
+    physics.setThreadCount(1);
+    physics.initialize();
+    physics.spawnCubes(BODY_COUNT, 1.0f);
+}
+
+// the loop the engine had before: an accumulator stepped from the render thread
+static Result runSingleThread() {
+
+    resetScene();
+
+    const double STEP_TIME = PhysicsThread::STEP_TIME;
+
+    Result result = { 0, 0, 0 };
+
+    RenderState previous, current, drawn;
+    Physics::getInstance().saveRenderState(current);
+    previous = current;
+
+    double accumulator = 0;
+    double last = getTime();
+    double end = last + DURATION;
+
+    while (getTime() < end) {
+
+        double now = getTime();
+        accumulator += now - last;
+        last = now;
+
+        if (accumulator > STEP_TIME * PhysicsThread::MAX_CATCH_UP_STEPS) {
+            result.droppedSteps += (unsigned int)(accumulator / STEP_TIME) - PhysicsThread::MAX_CATCH_UP_STEPS;
+            accumulator = STEP_TIME * PhysicsThread::MAX_CATCH_UP_STEPS;
+        }
+
+        while (accumulator >= STEP_TIME) {
+            Physics::getInstance().step(STEP_TIME);
+            swap(previous, current);
+            Physics::getInstance().saveRenderState(current);
+            accumulator -= STEP_TIME;
+            result.steps++;
+        }
+
+        interpolateRenderStates(previous, current, (float)(accumulator / STEP_TIME), drawn);
+        present(result.frames++);
+    }
+
+    return result;
+}
+
+static Result runPhysicsThread() {
+
+    resetScene();
+
+    PhysicsThread& physicsThread = PhysicsThread::getInstance();
+
+    Result result = { 0, 0, 0 };
+
+    RenderState drawn;
+
+    double end = getTime() + DURATION;
+
+    physicsThread.start();
+
+    while (getTime() < end) {
+
+        physicsThread.setGravity(vec3(0, 0, -9.8f));
+        physicsThread.updateSnapshot();
+
+        const PhysicsSnapshot& snapshot = physicsThread.getSnapshot();
+        interpolateRenderStates(snapshot.previous, snapshot.current, physicsThread.getAlpha(getTime()), drawn);
+        present(result.frames++);
+    }
+
+    physicsThread.stop();
+
+    result.steps = physicsThread.getCompletedSteps();
+    result.droppedSteps = physicsThread.getDroppedSteps();
+
+    return result;
+}
+
+static void print(const char* name, const Result& result) {
+    printf("%-16s %10.1f %10.1f %10.1f %12u\n", name, result.steps / DURATION, result.droppedSteps / DURATION,
+           result.frames / DURATION, result.steps + result.droppedSteps);
+}
+
+int main() {
+
+    Physics::getInstance().initialize();
+
+    printf("%u bodies, %.0f Hz physics, %.0f Hz display, a %.0f ms stall every %u frames, %.0f s each\n", BODY_COUNT,
+           1.0 / PhysicsThread::STEP_TIME, 1.0 / FRAME_TIME, STALL_TIME * 1e3, STALL_PERIOD_FRAMES, DURATION);
+    printf("%-16s %10s %10s %10s %12s\n", "", "steps/s", "dropped/s", "frames/s", "steps due");
+
+    print("render thread", runSingleThread());
+    print("physics thread", runPhysicsThread());
+
+    Physics::getInstance().finalize();
+
+    return 0;
+}
@@ -0,0 +1,126 @@
+// headless driver for the physics core: fills the walls with boxes, steps at a fixed dt for a number of frames,
+// and prints the average time of every stage, for profiling on a desktop or a server
+//
+// usage: physics_host [bodies = 1000] [frames = 600] [dt = 1/60] [threads = 0, one per core] [state directory]
+//                     [max substeps = 4] [chrome trace file, needs -DPHYSICS_PROFILING=ON]
+//
+// host build: cmake -S app -B build && cmake --build build --target physics_host
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FrameStats.h"
+#include "Physics.h"
+#include "Profiler.h"
+#include "StateStorage.h"
+
+extern "C" {
+#include "generalUtils.h"
+}
+
+static void printStage(const char* name, double seconds, unsigned int frames) {
+    printf("  %-16s %9.3f ms\n", name, seconds * 1000.0 / frames);
+}
+
+int main(int argc, char** argv) {
+
+    unsigned int bodyCount = argc > 1 ? (unsigned int) atoi(argv[1]) : 1000;
+    unsigned int frameCount = argc > 2 ? (unsigned int) atoi(argv[2]) : 600;
+    double dt = argc > 3 ? atof(argv[3]) : 1.0 / 60.0;
+    unsigned int threadCount = argc > 4 ? (unsigned int) atoi(argv[4]) : 0;
+
+    if (frameCount == 0 || dt <= 0) {
+        fprintf(stderr, "usage: %s [bodies] [frames] [dt] [threads] [state directory] [max substeps] [trace file]\n", argv[0]);
+        return 1;
+    }
+
+    // without a directory nothing is loaded or saved, so every run starts from the same scene
+    bool keepState = argc > 5 && argv[5][0] != 0;
+    DirectoryStorage storage(keepState ? argv[5] : ".");
+
+    const char* traceFileName = argc > 7 ? argv[7] : nullptr;
+    if (traceFileName != nullptr && !Profiler::isEnabled())
+        fprintf(stderr, "profiling is compiled out, configure with -DPHYSICS_PROFILING=ON for a trace\n");
+
+    PROFILE_THREAD_NAME("main");
+
+    Physics& physics = Physics::getInstance();
+
+    physics.setThreadCount(threadCount);
+    if (argc > 6)
+        physics.setMaxSubSteps((unsigned int) atoi(argv[6]));
+    if (keepState)
+        physics.setStorage(&storage);
+
+    physics.initialize();
+    // a world restored from the state directory is stepped as it was saved, otherwise the lattice replaces
+    // the default cube before anything is timed
+    if (!physics.isStateRestored())
+        physics.spawnCubes(bodyCount, 1.0f);
+
+    PhysicsTimings sum = PhysicsTimings();
+    FrameStats stats;
+
+    double start = getTime();
+
+    for (unsigned int frame = 0; frame < frameCount; frame++) {
+
+        physics.step(dt);
+
+        const PhysicsTimings& timings = physics.getTimings();
+
+        sum.broadphase += timings.broadphase;
+        sum.narrowphase += timings.narrowphase;
+        sum.islands += timings.islands;
+        sum.velocitySolver += timings.velocitySolver;
+        sum.integration += timings.integration;
+        sum.positionSolver += timings.positionSolver;
+        sum.total += timings.total;
+        sum.subStepCount += timings.subStepCount;
+
+        stats.addPhysicsStep(timings.total);
+    }
+
+    double elapsed = getTime() - start;
+
+    const World& world = physics.getWorld();
+
+    printf("%u bodies, %u frames of %.4f s on %u threads, %.3f s wall time\n", world.getBodyCount(), frameCount, dt,
+           physics.getThreadCount(), elapsed);
+    printf("  %u pairs, %u manifolds, %u sleeping at the end, state hash %016llx\n",
+           (unsigned int) physics.getPairs().size(), (unsigned int) physics.getManifolds().size(),
+           world.getBodies().getSleepingCount(), (unsigned long long) physics.calcStateHash());
+
+    printf("average per frame, %.2f substeps:\n", (double) sum.subStepCount / frameCount);
+    printStage("broadphase", sum.broadphase, frameCount);
+    printStage("narrowphase", sum.narrowphase, frameCount);
+    printStage("islands", sum.islands, frameCount);
+    printStage("velocity solver", sum.velocitySolver, frameCount);
+    printStage("integration", sum.integration, frameCount);
+    printStage("position solver", sum.positionSolver, frameCount);
+    printStage("total", sum.total, frameCount);
+
+    StatsSummary frames = stats.getSummary().physicsTime;
+    printf("frame time over the last %u frames: p50 %.3f ms, p95 %.3f ms, p99 %.3f ms, max %.3f ms\n", frames.count,
+           frames.p50 * 1000.0, frames.p95 * 1000.0, frames.p99 * 1000.0, frames.max * 1000.0);
+
+    physics.finalize();
+
+    if (traceFileName != nullptr && Profiler::isEnabled()) {
+
+        string trace = Profiler::getInstance().exportChromeTrace();
+
+        FILE* traceFile = fopen(traceFileName, "wb");
+        if (traceFile == nullptr) {
+            fprintf(stderr, "can't write %s\n", traceFileName);
+            return 1;
+        }
+
+        fwrite(trace.data(), 1, trace.size(), traceFile);
+        fclose(traceFile);
+
+        printf("trace written to %s\n", traceFileName);
+    }
+
+    return 0;
+}
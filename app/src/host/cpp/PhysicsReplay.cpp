@@ -0,0 +1,119 @@
+// headless player for the replay.bin the app leaves in its external files directory: restores the snapshot
+// the recording starts from, steps it with the recorded gravity and prints the step timings, so a run seen
+// on a device can be debugged and profiled on a desktop, or kept as a regression benchmark
+// every step with a recorded state hash is checked against the replayed state, the exit code is 2 on a mismatch;
+// across platforms the hashes only hold when both the app and the player are built with -DPHYSICS_DETERMINISTIC=ON
+//
+// usage: physics_replay <replay file> [threads = 0, one per core] [final snapshot file]
+//
+// host build: cmake -S app -B build && cmake --build build --target physics_replay
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FrameStats.h"
+#include "MappedFile.h"
+#include "Physics.h"
+#include "Replay.h"
+
+extern "C" {
+#include "generalUtils.h"
+}
+
+int main(int argc, char** argv) {
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <replay file> [threads] [final snapshot file]\n", argv[0]);
+        return 1;
+    }
+
+    unsigned int threadCount = argc > 2 ? (unsigned int) atoi(argv[2]) : 0;
+    const char* finalSnapshotFileName = argc > 3 ? argv[3] : nullptr;
+
+    MappedFile file;
+    ReplayPlayer player;
+    if (!file.open(argv[1]) || !player.open(file.getData(), file.getSize())) {
+        fprintf(stderr, "can't read a recording from %s\n", argv[1]);
+        return 1;
+    }
+
+    Physics& physics = Physics::getInstance();
+
+    physics.setThreadCount(threadCount);
+    physics.initialize();
+
+    if (!physics.loadSnapshot(player.getSnapshot(), player.getSnapshotSize())) {
+        fprintf(stderr, "the snapshot of %s doesn't fit this build\n", argv[1]);
+        return 1;
+    }
+
+    if (player.getHashInterval() > 0 && player.isDeterministic() != Physics::isDeterministic())
+        fprintf(stderr, "the recording was made by a %s build and this one is %s, hashes may differ\n",
+                player.isDeterministic() ? "deterministic" : "fast", Physics::isDeterministic() ? "deterministic" : "fast");
+
+    FrameStats stats;
+    unsigned int stepCount = 0;
+    unsigned int checkedCount = 0, mismatchCount = 0;
+    vec3 gravity;
+
+    double start = getTime();
+
+    while (player.nextStep(gravity)) {
+
+        physics.setGravity(gravity);
+        physics.step(player.getStepTime());
+
+        stats.addPhysicsStep(physics.getTimings().total);
+        stepCount++;
+
+        uint64_t recordedHash;
+        if (player.getStepHash(recordedHash)) {
+
+            uint64_t hash = physics.calcStateHash();
+            if (hash != recordedHash) {
+                if (mismatchCount == 0)
+                    fprintf(stderr, "diverged at step %u: state hash %016llx, recorded %016llx\n", stepCount,
+                            (unsigned long long) hash, (unsigned long long) recordedHash);
+                mismatchCount++;
+            }
+
+            checkedCount++;
+        }
+    }
+
+    double elapsed = getTime() - start;
+
+    if (stepCount != player.getStepCount())
+        fprintf(stderr, "the recording ends after %u of %u steps\n", stepCount, player.getStepCount());
+
+    const World& world = physics.getWorld();
+
+    printf("%u bodies, %u steps of %.4f s on %u threads, %.3f s wall time\n", world.getBodyCount(), stepCount,
+           player.getStepTime(), physics.getThreadCount(), elapsed);
+    printf("  %u manifolds, %u sleeping at the end, state hash %016llx\n",
+           (unsigned int) physics.getManifolds().size(), world.getBodies().getSleepingCount(),
+           (unsigned long long) physics.calcStateHash());
+    printf("  %u of %u recorded state hashes match\n", checkedCount - mismatchCount, checkedCount);
+
+    StatsSummary steps = stats.getSummary().physicsTime;
+    printf("step time over the last %u steps: p50 %.3f ms, p95 %.3f ms, p99 %.3f ms, max %.3f ms\n", steps.count,
+           steps.p50 * 1000.0, steps.p95 * 1000.0, steps.p99 * 1000.0, steps.max * 1000.0);
+
+    if (finalSnapshotFileName != nullptr) {
+
+        vector<unsigned char> snapshot;
+        physics.saveSnapshot(snapshot);
+
+        FILE* snapshotFile = fopen(finalSnapshotFileName, "wb");
+        if (snapshotFile == nullptr || fwrite(snapshot.data(), 1, snapshot.size(), snapshotFile) != snapshot.size()) {
+            fprintf(stderr, "can't write %s\n", finalSnapshotFileName);
+            return 1;
+        }
+
+        fclose(snapshotFile);
+    }
+
+    physics.finalize();
+
+    return mismatchCount > 0 ? 2 : 0;
+}
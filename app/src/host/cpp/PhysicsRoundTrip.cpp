@@ -0,0 +1,112 @@
+// checks that a snapshot holds the whole state of the simulation: lets a scene settle until most of it sleeps,
+// then records it from there the way the app does on a resume, with the device tilting the gravity every step,
+// and replays the recording with the state hash of every step checked, once with every broadphase;
+// the exit code is 2 on a mismatch
+//
+// usage: physics_roundtrip [bodies = 500] [settle steps = 300] [recorded steps = 120] [threads = 1]
+//
+// host build: cmake -S app -B build && cmake --build build --target physics_roundtrip, run by ctest
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+
+#include "Physics.h"
+#include "Replay.h"
+
+static const double STEP_TIME = 1.0 / 60.0;
+
+static const BroadphaseType BROADPHASE_TYPES[] = { SweepAndPrune, AabbTree, UniformGrid };
+static const char* BROADPHASE_NAMES[] = { "sweep and prune", "aabb tree", "uniform grid" };
+
+static bool checkRoundTrip(BroadphaseType type, const char* name, unsigned int bodyCount, unsigned int settleSteps,
+                           unsigned int stepCount) {
+
+    Physics& physics = Physics::getInstance();
+
+    physics.setBroadphase(type);
+    physics.initialize();
+    physics.spawnCubes(bodyCount, 1.0f);
+
+    for (unsigned int step = 0; step < settleSteps; step++)
+        physics.step(STEP_TIME);
+
+    unsigned int sleepingCount = physics.getWorld().getBodies().getSleepingCount();
+
+    vector<unsigned char> snapshot;
+    physics.saveSnapshot(snapshot);
+
+    ReplayRecorder recorder;
+    recorder.setHashInterval(1);
+    recorder.start(snapshot, (float) STEP_TIME);
+
+    for (unsigned int step = 0; step < stepCount; step++) {
+
+        // a slow tilt, enough to wake some of the sleepers again
+        float angle = step * 0.01f;
+        physics.setGravity(recorder.recordStep(vec3(sinf(angle), 0, -cosf(angle)) * 9.8f));
+        physics.step(STEP_TIME);
+
+        recorder.recordHash(physics.calcStateHash());
+    }
+
+    recorder.stop();
+
+    vector<unsigned char> recording;
+    recorder.save(recording);
+
+    ReplayPlayer player;
+    bool matched = player.open(recording.data(), recording.size()) &&
+                   physics.loadSnapshot(player.getSnapshot(), player.getSnapshotSize());
+    if (!matched)
+        fprintf(stderr, "%s: the recording doesn't load\n", name);
+
+    unsigned int step = 0;
+    vec3 gravity;
+
+    while (matched && player.nextStep(gravity)) {
+
+        physics.setGravity(gravity);
+        physics.step(player.getStepTime());
+        step++;
+
+        uint64_t hash = physics.calcStateHash(), recordedHash;
+        if (player.getStepHash(recordedHash) && hash != recordedHash) {
+            fprintf(stderr, "%s: diverged at step %u of the replay: state hash %016llx, recorded %016llx\n",
+                    name, step, (unsigned long long) hash, (unsigned long long) recordedHash);
+            matched = false;
+        }
+    }
+
+    if (matched && step != stepCount) {
+        fprintf(stderr, "%s: the replay ends after %u of %u steps\n", name, step, stepCount);
+        matched = false;
+    }
+
+    if (matched)
+        printf("%s: %u replayed steps match, recorded from step %u with %u of %u bodies sleeping\n", name,
+               stepCount, settleSteps, sleepingCount, physics.getWorld().getBodyCount());
+
+    physics.finalize();
+
+    return matched;
+}
+
+int main(int argc, char** argv) {
+
+    unsigned int bodyCount = argc > 1 ? (unsigned int) atoi(argv[1]) : 500;
+    unsigned int settleSteps = argc > 2 ? (unsigned int) atoi(argv[2]) : 300;
+    unsigned int stepCount = argc > 3 ? (unsigned int) atoi(argv[3]) : 120;
+    unsigned int threadCount = argc > 4 ? (unsigned int) atoi(argv[4]) : 1;
+
+    Physics::getInstance().setThreadCount(threadCount);
+
+    bool matched = true;
+    for (unsigned int type = 0; type < sizeof(BROADPHASE_TYPES) / sizeof(BROADPHASE_TYPES[0]); type++)
+        matched = checkRoundTrip(BROADPHASE_TYPES[type], BROADPHASE_NAMES[type], bodyCount, settleSteps, stepCount) &&
+                  matched;
+
+    return matched ? 0 : 2;
+}
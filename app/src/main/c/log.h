@@ -1,8 +1,28 @@
 #ifndef PEOPLEWATCHER_LOG_H
 #define PEOPLEWATCHER_LOG_H
 
+#ifdef __ANDROID__
+
 #include <android/log.h>
 
 #define print_log(level, tag, ...) __android_log_print(level, tag, __VA_ARGS__);
 
+#else
+
+#include <stdio.h>
+
+// same priorities as android/log.h, so callers stay unchanged on a desktop host
+enum {
+    ANDROID_LOG_VERBOSE = 2,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL
+};
+
+#define print_log(level, tag, ...) { fprintf(stderr, "%s: ", tag); fprintf(stderr, __VA_ARGS__); fprintf(stderr, "\n"); }
+
+#endif
+
 #endif //PEOPLEWATCHER_LOG_H
@@ -0,0 +1,36 @@
+#ifndef PHYSICSTEST_AABB_H
+#define PHYSICSTEST_AABB_H
+
+#include <glm/glm.hpp>
+
+using namespace glm;
+
+struct Aabb {
+    vec3 min, max;
+
+    bool overlaps(const Aabb& other) const {
+        return min.x <= other.max.x && other.min.x <= max.x &&
+               min.y <= other.max.y && other.min.y <= max.y &&
+               min.z <= other.max.z && other.min.z <= max.z;
+    }
+
+    bool contains(const Aabb& other) const {
+        return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z &&
+               other.max.x <= max.x && other.max.y <= max.y && other.max.z <= max.z;
+    }
+
+    Aabb merge(const Aabb& other) const {
+        return { glm::min(min, other.min), glm::max(max, other.max) };
+    }
+
+    Aabb expand(float margin) const {
+        return { min - vec3(margin), max + vec3(margin) };
+    }
+
+    float getSurfaceArea() const {
+        vec3 size = max - min;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+};
+
+#endif //PHYSICSTEST_AABB_H
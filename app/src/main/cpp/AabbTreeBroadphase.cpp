@@ -0,0 +1,449 @@
+#include "AabbTreeBroadphase.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+const int AabbTreeBroadphase::NULL_NODE;
+
+AabbTreeBroadphase::AabbTreeBroadphase(float margin) :
+    margin(margin), root(NULL_NODE), freeList(NULL_NODE), aabbs(nullptr) {
+
+}
+
+const char* AabbTreeBroadphase::getName() const {
+    return "aabb tree";
+}
+
+int AabbTreeBroadphase::allocateNode() {
+
+    if (freeList == NULL_NODE) {
+        Node node = { };
+        node.parent = NULL_NODE;
+        node.height = -1;
+        nodes.push_back(node);
+        freeList = (int)nodes.size() - 1;
+    }
+
+    int node = freeList;
+    freeList = nodes[node].parent;
+
+    nodes[node].parent = NULL_NODE;
+    nodes[node].child1 = NULL_NODE;
+    nodes[node].child2 = NULL_NODE;
+    nodes[node].height = 0;
+
+    return node;
+}
+
+void AabbTreeBroadphase::freeNode(int node) {
+    nodes[node].parent = freeList;
+    nodes[node].height = -1;
+    freeList = node;
+}
+
+void AabbTreeBroadphase::update(const Aabb* aabbs, unsigned int count) {
+
+    this->aabbs = aabbs;
+
+    unsigned int oldCount = (unsigned int)leaves.size();
+
+    for (unsigned int body = count; body < oldCount; body++) {
+        removeLeaf(leaves[body]);
+        freeNode(leaves[body]);
+    }
+
+    leaves.resize(count, NULL_NODE);
+
+    unsigned int moved = count - std::min(count, oldCount);
+    for (unsigned int body = 0; body < std::min(count, oldCount); body++)
+        if (!nodes[leaves[body]].aabb.contains(aabbs[body]))
+            moved++;
+
+    // reinserting a large share of the leaves one by one is slower and gives a looser tree
+    // than building it again in one go
+    if (moved > count / 8 + 1) {
+        rebuild();
+        return;
+    }
+
+    for (unsigned int body = 0; body < count; body++) {
+
+        int leaf = leaves[body];
+
+        if (leaf != NULL_NODE) {
+            // still inside its fat box, nothing to do
+            if (nodes[leaf].aabb.contains(aabbs[body]))
+                continue;
+
+            removeLeaf(leaf);
+        } else {
+            leaf = allocateNode();
+            nodes[leaf].body = body;
+            leaves[body] = leaf;
+        }
+
+        nodes[leaf].aabb = aabbs[body].expand(margin);
+        insertLeaf(leaf);
+    }
+}
+
+void AabbTreeBroadphase::rebuild() {
+
+    unsigned int count = (unsigned int)leaves.size();
+
+    nodes.clear();
+    freeList = NULL_NODE;
+    root = NULL_NODE;
+
+    buildLeaves.resize(count);
+
+    for (unsigned int body = 0; body < count; body++) {
+
+        int leaf = allocateNode();
+        nodes[leaf].body = body;
+        nodes[leaf].aabb = aabbs[body].expand(margin);
+
+        leaves[body] = leaf;
+        buildLeaves[body] = leaf;
+    }
+
+    if (count > 0) {
+        root = build(0, count);
+        nodes[root].parent = NULL_NODE;
+    }
+}
+
+int AabbTreeBroadphase::build(unsigned int begin, unsigned int end) {
+
+    if (end - begin == 1)
+        return buildLeaves[begin];
+
+    // split at the median of the box centers along the axis they spread the most
+    vec3 centerMin = vec3(INFINITY), centerMax = vec3(-INFINITY);
+    for (unsigned int index = begin; index < end; index++) {
+        const Aabb& aabb = nodes[buildLeaves[index]].aabb;
+        vec3 center = aabb.min + aabb.max;
+        centerMin = glm::min(centerMin, center);
+        centerMax = glm::max(centerMax, center);
+    }
+
+    vec3 spread = centerMax - centerMin;
+    unsigned int axis = 0;
+    if (spread.y > spread[axis])
+        axis = 1;
+    if (spread.z > spread[axis])
+        axis = 2;
+
+    unsigned int middle = begin + (end - begin) / 2;
+
+    const vector<Node>& sorted = this->nodes;
+    nth_element(buildLeaves.begin() + begin, buildLeaves.begin() + middle, buildLeaves.begin() + end,
+                [&sorted, axis](int a, int b) {
+                    return sorted[a].aabb.min[axis] + sorted[a].aabb.max[axis] <
+                           sorted[b].aabb.min[axis] + sorted[b].aabb.max[axis];
+                });
+
+    int child1 = build(begin, middle);
+    int child2 = build(middle, end);
+
+    int node = allocateNode();
+    nodes[node].child1 = child1;
+    nodes[node].child2 = child2;
+    nodes[node].aabb = nodes[child1].aabb.merge(nodes[child2].aabb);
+    nodes[node].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+
+    nodes[child1].parent = node;
+    nodes[child2].parent = node;
+
+    return node;
+}
+
+void AabbTreeBroadphase::insertLeaf(int leaf) {
+
+    if (root == NULL_NODE) {
+        root = leaf;
+        nodes[root].parent = NULL_NODE;
+        return;
+    }
+
+    // find the best sibling, descending while the cost of pushing the leaf lower is smaller
+    Aabb leafAabb = nodes[leaf].aabb;
+    int index = root;
+
+    while (!nodes[index].isLeaf()) {
+
+        int child1 = nodes[index].child1;
+        int child2 = nodes[index].child2;
+
+        float area = nodes[index].aabb.getSurfaceArea();
+        float combinedArea = nodes[index].aabb.merge(leafAabb).getSurfaceArea();
+
+        // cost of making a new parent for this node and the leaf
+        float cost = 2.0f * combinedArea;
+
+        // minimum cost of pushing the leaf further down the tree
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        float childCosts[2];
+        int children[2] = { child1, child2 };
+
+        for (unsigned int childIndex = 0; childIndex < 2; childIndex++) {
+
+            const Node& child = nodes[children[childIndex]];
+            float childArea = child.aabb.merge(leafAabb).getSurfaceArea();
+
+            if (child.isLeaf())
+                childCosts[childIndex] = childArea + inheritanceCost;
+            else
+                childCosts[childIndex] = childArea - child.aabb.getSurfaceArea() + inheritanceCost;
+        }
+
+        if (cost < childCosts[0] && cost < childCosts[1])
+            break;
+
+        index = childCosts[0] < childCosts[1] ? child1 : child2;
+    }
+
+    int sibling = index;
+
+    int oldParent = nodes[sibling].parent;
+    int newParent = allocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].aabb = leafAabb.merge(nodes[sibling].aabb);
+    nodes[newParent].height = nodes[sibling].height + 1;
+
+    if (oldParent != NULL_NODE) {
+        if (nodes[oldParent].child1 == sibling)
+            nodes[oldParent].child1 = newParent;
+        else
+            nodes[oldParent].child2 = newParent;
+    } else
+        root = newParent;
+
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    // refit and rebalance the ancestors
+    index = nodes[leaf].parent;
+    while (index != NULL_NODE) {
+
+        index = balance(index);
+
+        int child1 = nodes[index].child1;
+        int child2 = nodes[index].child2;
+
+        nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+        nodes[index].aabb = nodes[child1].aabb.merge(nodes[child2].aabb);
+
+        index = nodes[index].parent;
+    }
+}
+
+void AabbTreeBroadphase::removeLeaf(int leaf) {
+
+    if (leaf == root) {
+        root = NULL_NODE;
+        return;
+    }
+
+    int parent = nodes[leaf].parent;
+    int grandParent = nodes[parent].parent;
+    int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+    if (grandParent != NULL_NODE) {
+
+        // the sibling takes the place of the parent
+        if (nodes[grandParent].child1 == parent)
+            nodes[grandParent].child1 = sibling;
+        else
+            nodes[grandParent].child2 = sibling;
+
+        nodes[sibling].parent = grandParent;
+        freeNode(parent);
+
+        int index = grandParent;
+        while (index != NULL_NODE) {
+
+            index = balance(index);
+
+            int child1 = nodes[index].child1;
+            int child2 = nodes[index].child2;
+
+            nodes[index].aabb = nodes[child1].aabb.merge(nodes[child2].aabb);
+            nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+
+            index = nodes[index].parent;
+        }
+    } else {
+        root = sibling;
+        nodes[sibling].parent = NULL_NODE;
+        freeNode(parent);
+    }
+
+    nodes[leaf].parent = NULL_NODE;
+}
+
+// rotates the taller grandchild up when the subtree of a is out of balance, returns the new subtree root
+int AabbTreeBroadphase::balance(int a) {
+
+    Node& nodeA = nodes[a];
+    if (nodeA.isLeaf() || nodeA.height < 2)
+        return a;
+
+    int b = nodeA.child1;
+    int c = nodeA.child2;
+
+    int heightDifference = nodes[c].height - nodes[b].height;
+
+    // rotate c up
+    if (heightDifference > 1) {
+
+        int f = nodes[c].child1;
+        int g = nodes[c].child2;
+
+        nodes[c].child1 = a;
+        nodes[c].parent = nodes[a].parent;
+        nodes[a].parent = c;
+
+        if (nodes[c].parent != NULL_NODE) {
+            if (nodes[nodes[c].parent].child1 == a)
+                nodes[nodes[c].parent].child1 = c;
+            else
+                nodes[nodes[c].parent].child2 = c;
+        } else
+            root = c;
+
+        // the shorter grandchild goes under a
+        if (nodes[f].height > nodes[g].height) {
+            nodes[c].child2 = f;
+            nodes[a].child2 = g;
+            nodes[g].parent = a;
+        } else {
+            nodes[c].child2 = g;
+            nodes[a].child2 = f;
+            nodes[f].parent = a;
+        }
+
+        int a2 = nodes[a].child2;
+        nodes[a].aabb = nodes[b].aabb.merge(nodes[a2].aabb);
+        nodes[a].height = 1 + std::max(nodes[b].height, nodes[a2].height);
+
+        int c2 = nodes[c].child2;
+        nodes[c].aabb = nodes[a].aabb.merge(nodes[c2].aabb);
+        nodes[c].height = 1 + std::max(nodes[a].height, nodes[c2].height);
+
+        return c;
+    }
+
+    // rotate b up
+    if (heightDifference < -1) {
+
+        int d = nodes[b].child1;
+        int e = nodes[b].child2;
+
+        nodes[b].child1 = a;
+        nodes[b].parent = nodes[a].parent;
+        nodes[a].parent = b;
+
+        if (nodes[b].parent != NULL_NODE) {
+            if (nodes[nodes[b].parent].child1 == a)
+                nodes[nodes[b].parent].child1 = b;
+            else
+                nodes[nodes[b].parent].child2 = b;
+        } else
+            root = b;
+
+        if (nodes[d].height > nodes[e].height) {
+            nodes[b].child2 = d;
+            nodes[a].child1 = e;
+            nodes[e].parent = a;
+        } else {
+            nodes[b].child2 = e;
+            nodes[a].child1 = d;
+            nodes[d].parent = a;
+        }
+
+        int a1 = nodes[a].child1;
+        nodes[a].aabb = nodes[a1].aabb.merge(nodes[c].aabb);
+        nodes[a].height = 1 + std::max(nodes[a1].height, nodes[c].height);
+
+        int b2 = nodes[b].child2;
+        nodes[b].aabb = nodes[a].aabb.merge(nodes[b2].aabb);
+        nodes[b].height = 1 + std::max(nodes[a].height, nodes[b2].height);
+
+        return b;
+    }
+
+    return a;
+}
+
+void AabbTreeBroadphase::findPairs(vector<BodyPair>& pairs) {
+
+    if (root == NULL_NODE)
+        return;
+
+    unsigned int count = (unsigned int)leaves.size();
+
+    // query the tree with every tight box, report each pair once from its lower body
+    for (unsigned int body = 0; body < count; body++) {
+
+        const Aabb& aabb = aabbs[body];
+
+        stack.clear();
+        if (nodes[root].aabb.overlaps(aabb))
+            stack.push_back(root);
+
+        while (!stack.empty()) {
+
+            const Node& node = nodes[stack.back()];
+            stack.pop_back();
+
+            if (node.isLeaf()) {
+                // fat boxes overlap, keep only pairs whose real boxes do
+                if (node.body > body && aabbs[node.body].overlaps(aabb))
+                    pairs.push_back({ body, node.body });
+                continue;
+            }
+
+            // children are tested before they are pushed, saves a round trip through the stack
+            if (nodes[node.child1].aabb.overlaps(aabb))
+                stack.push_back(node.child1);
+            if (nodes[node.child2].aabb.overlaps(aabb))
+                stack.push_back(node.child2);
+        }
+    }
+}
+
+void AabbTreeBroadphase::query(const Aabb& aabb, vector<unsigned int>& bodies) {
+
+    if (root == NULL_NODE)
+        return;
+
+    stack.clear();
+    if (nodes[root].aabb.overlaps(aabb))
+        stack.push_back(root);
+
+    while (!stack.empty()) {
+
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+
+        if (node.isLeaf()) {
+            if (aabbs[node.body].overlaps(aabb))
+                bodies.push_back(node.body);
+            continue;
+        }
+
+        if (nodes[node.child1].aabb.overlaps(aabb))
+            stack.push_back(node.child1);
+        if (nodes[node.child2].aabb.overlaps(aabb))
+            stack.push_back(node.child2);
+    }
+}
+
+int AabbTreeBroadphase::getHeight() const {
+    return root == NULL_NODE ? 0 : nodes[root].height;
+}
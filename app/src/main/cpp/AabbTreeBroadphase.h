@@ -0,0 +1,68 @@
+#ifndef PHYSICSTEST_AABB_TREE_BROADPHASE_H
+#define PHYSICSTEST_AABB_TREE_BROADPHASE_H
+
+#include <vector>
+
+#include "Broadphase.h"
+
+using namespace std;
+
+// dynamic bounding volume tree over fattened body boxes
+// a body is only reinserted when it leaves its fat box, insertion picks the sibling
+// with the lowest surface area cost and the tree is kept balanced with rotations
+class AabbTreeBroadphase : public Broadphase {
+private:
+    static const int NULL_NODE = -1;
+
+    struct Node {
+        Aabb aabb;
+        // the free list is threaded through parent
+        int parent;
+        int child1, child2;
+        // leaves have height 0, free nodes -1
+        int height;
+        unsigned int body;
+
+        bool isLeaf() const {
+            return child1 == NULL_NODE;
+        }
+    };
+
+    const float margin;
+
+    vector<Node> nodes;
+    int root;
+    int freeList;
+
+    // leaf node of every body
+    vector<int> leaves;
+
+    const Aabb* aabbs;
+
+    vector<int> stack;
+
+    int allocateNode();
+    void freeNode(int node);
+
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+
+    int balance(int node);
+
+    // top-down median split over leaves[begin, end), used when many bodies arrive at once
+    vector<int> buildLeaves;
+    int build(unsigned int begin, unsigned int end);
+    void rebuild();
+public:
+    explicit AabbTreeBroadphase(float margin = 0.05f);
+
+    const char* getName() const override;
+
+    void update(const Aabb* aabbs, unsigned int count) override;
+    void findPairs(vector<BodyPair>& pairs) override;
+    void query(const Aabb& aabb, vector<unsigned int>& bodies) override;
+
+    int getHeight() const;
+};
+
+#endif //PHYSICSTEST_AABB_TREE_BROADPHASE_H
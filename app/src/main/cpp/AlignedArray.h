@@ -0,0 +1,106 @@
+#ifndef PHYSICSTEST_ALIGNED_ARRAY_H
+#define PHYSICSTEST_ALIGNED_ARRAY_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <new>
+
+// growable array of trivially copyable elements with an aligned base address,
+// used for the structure-of-arrays body storage so the integration passes can use aligned loads
+template <typename T, unsigned int ALIGNMENT = 32>
+class AlignedArray {
+private:
+    T* elements;
+    unsigned int count, capacity;
+public:
+    AlignedArray() : elements(nullptr), count(0), capacity(0) {
+
+    }
+
+    AlignedArray(const AlignedArray& other) : elements(nullptr), count(0), capacity(0) {
+        *this = other;
+    }
+
+    ~AlignedArray() {
+        free(elements);
+    }
+
+    AlignedArray& operator=(const AlignedArray& other) {
+
+        if (this == &other)
+            return *this;
+
+        reserve(other.count);
+        if (other.count > 0)
+            memcpy(elements, other.elements, other.count * sizeof(T));
+        count = other.count;
+
+        return *this;
+    }
+
+    void reserve(unsigned int newCapacity) {
+
+        if (newCapacity <= capacity)
+            return;
+
+        // keep a whole number of SIMD lanes allocated past the end
+        unsigned int lanes = ALIGNMENT / sizeof(T) > 0 ? ALIGNMENT / sizeof(T) : 1;
+        newCapacity = (newCapacity + lanes - 1) / lanes * lanes;
+
+        void* newElements = nullptr;
+        if (posix_memalign(&newElements, ALIGNMENT, newCapacity * sizeof(T)) != 0)
+            throw std::bad_alloc();
+
+        if (count > 0)
+            memcpy(newElements, elements, count * sizeof(T));
+
+        free(elements);
+
+        elements = (T*)newElements;
+        capacity = newCapacity;
+    }
+
+    void resize(unsigned int newCount) {
+
+        if (newCount > capacity)
+            reserve(newCount > capacity * 2 ? newCount : capacity * 2);
+
+        count = newCount;
+    }
+
+    void push_back(const T& element) {
+        resize(count + 1);
+        elements[count - 1] = element;
+    }
+
+    void pop_back() {
+        count--;
+    }
+
+    void clear() {
+        count = 0;
+    }
+
+    unsigned int size() const {
+        return count;
+    }
+
+    T* data() {
+        return elements;
+    }
+
+    const T* data() const {
+        return elements;
+    }
+
+    T& operator[](unsigned int index) {
+        return elements[index];
+    }
+
+    const T& operator[](unsigned int index) const {
+        return elements[index];
+    }
+};
+
+#endif //PHYSICSTEST_ALIGNED_ARRAY_H
@@ -18,7 +18,7 @@ void AssetManager::initialize(AAssetManager* nativeManager, string externalFiles
         return;
 
     this->nativeManager = nativeManager;
-    this->externalFilesDir = externalFilesDir;
+    this->externalFiles.setDirectory(externalFilesDir);
 
     this->initialized = 1;
 }
@@ -89,37 +89,13 @@ GLuint AssetManager::loadTextureAsset(string assertName) {
 }
 
 bool AssetManager::loadExternalBinaryFile(string fileName, void* dest, unsigned int size) {
-
-    string fullFileName = this->externalFilesDir + "/" + fileName;
-
-    bool result = false;
-
-    FILE* fileHandle = fopen(fullFileName.c_str(), "rb");
-    if (fileHandle != nullptr) {
-
-        size_t readed = fread(dest, 1, size, fileHandle);
-        if (readed == size)
-            result = true;
-
-        fclose(fileHandle);
-        fileHandle = nullptr;
-    }
-
-    return result;
+    return this->externalFiles.loadBinaryFile(fileName, dest, size);
 }
 
-void AssetManager::saveExternalBinaryFile(string fileName, void* src, unsigned int size) {
-
-    string fullFileName = this->externalFilesDir + "/" + fileName;
-
-    bool result = false;
-
-    FILE* fileHandle = fopen(fullFileName.c_str(), "w");
-    if (fileHandle != nullptr) {
-
-        size_t written = fwrite(src, 1, size, fileHandle);
+bool AssetManager::saveExternalBinaryFile(string fileName, void* src, unsigned int size) {
+    return this->externalFiles.saveBinaryFile(fileName, src, size);
+}
 
-        fclose(fileHandle);
-        fileHandle = nullptr;
-    }
-}
\ No newline at end of file
+StateStorage& AssetManager::getExternalStorage() {
+    return this->externalFiles;
+}
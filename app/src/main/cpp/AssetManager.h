@@ -8,6 +8,8 @@
 
 #include <string>
 
+#include "StateStorage.h"
+
 using namespace std;
 
 class AssetManager {
@@ -27,7 +29,7 @@ private:
 
     AAssetManager* nativeManager;
 
-    string externalFilesDir;
+    DirectoryStorage externalFiles;
 public:
     void initialize(AAssetManager* nativeManager, string externalFilesDir);
     void finalize();
@@ -36,7 +38,10 @@ public:
     GLuint loadTextureAsset(string assertName);
 
     bool loadExternalBinaryFile(string fileName, void* dest, unsigned int size);
-    void saveExternalBinaryFile(string fileName, void* src, unsigned int size);
+    bool saveExternalBinaryFile(string fileName, void* src, unsigned int size);
+
+    // the external files directory, handed to the physics for its state
+    StateStorage& getExternalStorage();
 };
 
 #endif //PHYSICSTEST_ASSET_MANAGER_H
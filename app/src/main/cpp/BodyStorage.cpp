@@ -0,0 +1,542 @@
+#include "BodyStorage.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "SceneSnapshot.h"
+
+AlignedArray<float> BodyStorage::* const BodyStorage::FLOAT_ARRAYS[] = {
+        &BodyStorage::positionX, &BodyStorage::positionY, &BodyStorage::positionZ,
+        &BodyStorage::orientationX, &BodyStorage::orientationY, &BodyStorage::orientationZ,
+        &BodyStorage::orientationW,
+        &BodyStorage::linearVelocityX, &BodyStorage::linearVelocityY, &BodyStorage::linearVelocityZ,
+        &BodyStorage::angularVelocityX, &BodyStorage::angularVelocityY, &BodyStorage::angularVelocityZ,
+        &BodyStorage::sizeX, &BodyStorage::sizeY, &BodyStorage::sizeZ,
+        &BodyStorage::invMass,
+        &BodyStorage::localInvInertiaX, &BodyStorage::localInvInertiaY, &BodyStorage::localInvInertiaZ,
+        &BodyStorage::sleepTime
+};
+
+const unsigned int BodyStorage::FLOAT_ARRAY_COUNT = sizeof(FLOAT_ARRAYS) / sizeof(FLOAT_ARRAYS[0]);
+
+BodyStorage::BodyStorage() : sleepingCount(0), kernel(&getIntegrationKernel()) {
+
+}
+
+unsigned int BodyStorage::add(vec3 position, quat orientation, vec3 size, float mass) {
+
+    vec3 sizeSq = size * size;
+
+    vec3 inertia = {
+        mass / 12.0f * (sizeSq.y + sizeSq.z),
+        mass / 12.0f * (sizeSq.x + sizeSq.z),
+        mass / 12.0f * (sizeSq.x + sizeSq.y)
+    };
+
+    // inertia *= 0.5f;
+
+    positionX.push_back(position.x);
+    positionY.push_back(position.y);
+    positionZ.push_back(position.z);
+
+    orientationX.push_back(orientation.x);
+    orientationY.push_back(orientation.y);
+    orientationZ.push_back(orientation.z);
+    orientationW.push_back(orientation.w);
+
+    linearVelocityX.push_back(0);
+    linearVelocityY.push_back(0);
+    linearVelocityZ.push_back(0);
+
+    angularVelocityX.push_back(0);
+    angularVelocityY.push_back(0);
+    angularVelocityZ.push_back(0);
+
+    sizeX.push_back(size.x);
+    sizeY.push_back(size.y);
+    sizeZ.push_back(size.z);
+
+    invMass.push_back(1.0f / mass);
+
+    localInvInertiaX.push_back(1.0f / inertia.x);
+    localInvInertiaY.push_back(1.0f / inertia.y);
+    localInvInertiaZ.push_back(1.0f / inertia.z);
+
+    sleepTime.push_back(0);
+    awake.push_back(1);
+
+    rotation.push_back(mat3(1.0f));
+    worldInvInertiaTensor.push_back(mat3(1.0f));
+    dirtyFlags.push_back(ALL_DIRTY);
+
+    return this->size() - 1;
+}
+
+void BodyStorage::remove(unsigned int index) {
+
+    unsigned int lastIndex = size() - 1;
+
+    if (!awake[index])
+        sleepingCount--;
+
+    for (unsigned int arrayIndex = 0; arrayIndex < FLOAT_ARRAY_COUNT; arrayIndex++) {
+        AlignedArray<float>& array = this->*FLOAT_ARRAYS[arrayIndex];
+        array[index] = array[lastIndex];
+        array.pop_back();
+    }
+
+    rotation[index] = rotation[lastIndex];
+    rotation.pop_back();
+
+    worldInvInertiaTensor[index] = worldInvInertiaTensor[lastIndex];
+    worldInvInertiaTensor.pop_back();
+
+    dirtyFlags[index] = dirtyFlags[lastIndex];
+    dirtyFlags.pop_back();
+
+    awake[index] = awake[lastIndex];
+    awake.pop_back();
+}
+
+void BodyStorage::clear() {
+
+    for (unsigned int arrayIndex = 0; arrayIndex < FLOAT_ARRAY_COUNT; arrayIndex++)
+        (this->*FLOAT_ARRAYS[arrayIndex]).clear();
+
+    rotation.clear();
+    worldInvInertiaTensor.clear();
+    dirtyFlags.clear();
+
+    awake.clear();
+    sleepingCount = 0;
+}
+
+void BodyStorage::reserve(unsigned int bodyCount) {
+
+    for (unsigned int arrayIndex = 0; arrayIndex < FLOAT_ARRAY_COUNT; arrayIndex++)
+        (this->*FLOAT_ARRAYS[arrayIndex]).reserve(bodyCount);
+
+    rotation.reserve(bodyCount);
+    worldInvInertiaTensor.reserve(bodyCount);
+    dirtyFlags.reserve(bodyCount);
+    awake.reserve(bodyCount);
+}
+
+unsigned int BodyStorage::size() const {
+    return positionX.size();
+}
+
+const vec3 BodyStorage::getPosition(unsigned int index) const {
+    return { positionX[index], positionY[index], positionZ[index] };
+}
+
+const quat BodyStorage::getOrientation(unsigned int index) const {
+    return quat(orientationW[index], orientationX[index], orientationY[index], orientationZ[index]);
+}
+
+const mat3 BodyStorage::getRotation(unsigned int index) const {
+
+    if (dirtyFlags[index] & ROTATION_DIRTY) {
+        rotation[index] = mat3_cast(getOrientation(index));
+        dirtyFlags[index] &= ~ROTATION_DIRTY;
+    }
+
+    return rotation[index];
+}
+
+const mat3 BodyStorage::getWorldInvInertiaTensor(unsigned int index) const {
+
+    if (dirtyFlags[index] & INERTIA_DIRTY) {
+
+        mat3 r = getRotation(index);
+        vec3 d = { localInvInertiaX[index], localInvInertiaY[index], localInvInertiaZ[index] };
+
+        // r * diag(d) * transpose(r), symmetric so only 6 entries are computed
+        vec3 row0 = vec3(r[0][0], r[1][0], r[2][0]);
+        vec3 row1 = vec3(r[0][1], r[1][1], r[2][1]);
+        vec3 row2 = vec3(r[0][2], r[1][2], r[2][2]);
+
+        float m00 = dot(row0 * d, row0), m01 = dot(row0 * d, row1), m02 = dot(row0 * d, row2);
+        float m11 = dot(row1 * d, row1), m12 = dot(row1 * d, row2);
+        float m22 = dot(row2 * d, row2);
+
+        worldInvInertiaTensor[index] = mat3(
+                vec3(m00, m01, m02),
+                vec3(m01, m11, m12),
+                vec3(m02, m12, m22));
+
+        dirtyFlags[index] &= ~INERTIA_DIRTY;
+    }
+
+    return worldInvInertiaTensor[index];
+}
+
+const vec3 BodyStorage::getSize(unsigned int index) const {
+    return { sizeX[index], sizeY[index], sizeZ[index] };
+}
+
+const vec3 BodyStorage::getLinearVelocity(unsigned int index) const {
+    return { linearVelocityX[index], linearVelocityY[index], linearVelocityZ[index] };
+}
+
+const vec3 BodyStorage::getAngularVelocity(unsigned int index) const {
+    return { angularVelocityX[index], angularVelocityY[index], angularVelocityZ[index] };
+}
+
+void BodyStorage::setVelocity(unsigned int index, vec3 linearVelocity, vec3 angularVelocity) {
+
+    linearVelocityX[index] = linearVelocity.x;
+    linearVelocityY[index] = linearVelocity.y;
+    linearVelocityZ[index] = linearVelocity.z;
+
+    angularVelocityX[index] = angularVelocity.x;
+    angularVelocityY[index] = angularVelocity.y;
+    angularVelocityZ[index] = angularVelocity.z;
+}
+
+void BodyStorage::setPosition(unsigned int index, vec3 position) {
+
+    positionX[index] = position.x;
+    positionY[index] = position.y;
+    positionZ[index] = position.z;
+
+    markDirty(index);
+}
+
+bool BodyStorage::isAwake(unsigned int index) const {
+    return this->awake[index] != 0;
+}
+
+void BodyStorage::setAwake(unsigned int index, bool awake) {
+
+    if (isAwake(index) == awake)
+        return;
+
+    this->awake[index] = awake ? 1 : 0;
+
+    if (awake) {
+        sleepingCount--;
+        sleepTime[index] = 0;
+    } else {
+        sleepingCount++;
+        setVelocity(index, vec3(0), vec3(0));
+    }
+}
+
+void BodyStorage::wakeAll() {
+
+    if (sleepingCount == 0)
+        return;
+
+    unsigned int count = this->size();
+    for (unsigned int index = 0; index < count; index++)
+        setAwake(index, true);
+}
+
+unsigned int BodyStorage::getSleepingCount() const {
+    return sleepingCount;
+}
+
+float BodyStorage::getSleepTime(unsigned int index) const {
+    return sleepTime[index];
+}
+
+void BodyStorage::setSleepTime(unsigned int index, float time) {
+    sleepTime[index] = time;
+}
+
+void BodyStorage::calcPoints(unsigned int index, vec3* points) const {
+
+    mat3 rotation = getRotation(index);
+    vec3 position = getPosition(index);
+
+    // half extents along the body axes, the corners are every +/- combination of them
+    vec3 x = rotation[0] * (sizeX[index] * 0.5f);
+    vec3 y = rotation[1] * (sizeY[index] * 0.5f);
+    vec3 z = rotation[2] * (sizeZ[index] * 0.5f);
+
+    vec3 xPos = position + x, xNeg = position - x;
+    vec3 yzPP = y + z, yzNP = z - y, yzPN = y - z, yzNN = -(y + z);
+
+    points[0] = xPos + yzPP;
+    points[1] = xPos + yzNP;
+    points[2] = xPos + yzPN;
+    points[3] = xPos + yzNN;
+
+    points[4] = xNeg + yzPP;
+    points[5] = xNeg + yzNP;
+    points[6] = xNeg + yzPN;
+    points[7] = xNeg + yzNN;
+}
+
+const Aabb BodyStorage::getAabb(unsigned int index) const {
+
+    mat3 rotation = getRotation(index);
+    vec3 halfSize = getSize(index) * 0.5f;
+
+    // projection of the rotated half extents onto the world axes
+    vec3 extent = abs(rotation[0]) * halfSize.x + abs(rotation[1]) * halfSize.y + abs(rotation[2]) * halfSize.z;
+    vec3 position = getPosition(index);
+
+    return { position - extent, position + extent };
+}
+
+void BodyStorage::calcAabbs(Aabb* aabbs) const {
+
+    unsigned int count = this->size();
+    for (unsigned int index = 0; index < count; index++)
+        if (awake[index])
+            aabbs[index] = getAabb(index);
+}
+
+const OrientedBox BodyStorage::getBox(unsigned int index) const {
+    return { getPosition(index), getRotation(index), getSize(index) * 0.5f };
+}
+
+void BodyStorage::markDirty(unsigned int index) {
+    dirtyFlags[index] = ALL_DIRTY;
+}
+
+// streaming passes
+
+IntegrationStreams BodyStorage::getStreams() {
+
+    IntegrationStreams streams = {
+            positionX.data(), positionY.data(), positionZ.data(),
+            orientationX.data(), orientationY.data(), orientationZ.data(), orientationW.data(),
+            linearVelocityX.data(), linearVelocityY.data(), linearVelocityZ.data(),
+            angularVelocityX.data(), angularVelocityY.data(), angularVelocityZ.data(),
+            this->size()
+    };
+
+    return streams;
+}
+
+void BodyStorage::setIntegrationKernel(const IntegrationKernel& kernel) {
+    this->kernel = &kernel;
+}
+
+float BodyStorage::calcMaxRelativeTravel(vec3 gravity, double dt) const {
+
+    float maxTravel = 0;
+    vec3 gravityDelta = gravity * (float)dt;
+
+    for (unsigned int index = 0; index < size(); index++) {
+
+        if (!awake[index])
+            continue;
+
+        vec3 size = getSize(index);
+        float radius = 0.5f * length(size);
+        float minSize = std::min(size.x, std::min(size.y, size.z));
+
+        // a corner moves with the body and at most the angular speed times the half diagonal around it
+        float speed = length(getLinearVelocity(index) + gravityDelta) + length(getAngularVelocity(index)) * radius;
+
+        maxTravel = std::max(maxTravel, speed * (float)dt / minSize);
+    }
+
+    return maxTravel;
+}
+
+void BodyStorage::applyGravity(vec3 gravity, double dt) {
+
+    vec3 delta = gravity * (float)dt;
+
+    kernel->addLinearVelocity(getStreams(), delta.x, delta.y, delta.z);
+
+    // cheaper to stream over everyone and stop the few sleepers again than to mask the stream
+    if (sleepingCount > 0) {
+        unsigned int count = this->size();
+        for (unsigned int index = 0; index < count; index++) {
+            if (!awake[index]) {
+                linearVelocityX[index] = 0;
+                linearVelocityY[index] = 0;
+                linearVelocityZ[index] = 0;
+            }
+        }
+    }
+}
+
+void BodyStorage::applyDamping(double dt, float damping) {
+
+    float m = 1.0f - (float)dt * damping;
+
+    kernel->scaleVelocities(getStreams(), m);
+}
+
+void BodyStorage::integrate(double dt) {
+
+    // with zero velocity a sleeper keeps its position, but the renormalization still moves the last bits
+    // of its orientation, which would leave its cached rotation stale
+    sleeperIndices.clear();
+    sleeperOrientations.clear();
+
+    if (sleepingCount > 0) {
+        unsigned int count = this->size();
+        for (unsigned int index = 0; index < count; index++) {
+            if (!awake[index]) {
+                sleeperIndices.push_back(index);
+                sleeperOrientations.push_back(getOrientation(index));
+            }
+        }
+    }
+
+    kernel->integrateTransforms(getStreams(), (float)dt);
+
+    for (unsigned int sleeper = 0; sleeper < sleeperIndices.size(); sleeper++) {
+
+        unsigned int index = sleeperIndices[sleeper];
+        const quat& orientation = sleeperOrientations[sleeper];
+
+        orientationX[index] = orientation.x;
+        orientationY[index] = orientation.y;
+        orientationZ[index] = orientation.z;
+        orientationW[index] = orientation.w;
+    }
+
+    // rotations and world inertia are rebuilt only for the bodies someone asks about,
+    // sleeping bodies did not move
+    if (sleepingCount == 0) {
+        if (this->size() > 0)
+            memset(dirtyFlags.data(), ALL_DIRTY, this->size());
+    } else {
+        unsigned int count = this->size();
+        for (unsigned int index = 0; index < count; index++)
+            if (awake[index])
+                dirtyFlags[index] = ALL_DIRTY;
+    }
+}
+
+// per body
+
+void BodyStorage::integrateTransforms(unsigned int index, vec3 positionDelta, vec3 rotationDelta) {
+
+    positionX[index] += positionDelta.x;
+    positionY[index] += positionDelta.y;
+    positionZ[index] += positionDelta.z;
+
+    quat orientation = getOrientation(index);
+    quat rotationDeltaQ = quat(0, rotationDelta.x, rotationDelta.y, rotationDelta.z);
+    orientation += (rotationDeltaQ * orientation) * 0.5f;
+    orientation = normalize(orientation);
+
+    orientationX[index] = orientation.x;
+    orientationY[index] = orientation.y;
+    orientationZ[index] = orientation.z;
+    orientationW[index] = orientation.w;
+
+    markDirty(index);
+}
+
+void BodyStorage::applyPseudoImpulse(unsigned int index, vec3 impulse, vec3 localPoint) {
+    this->integrateTransforms(index, this->invMass[index] * impulse,
+                              getWorldInvInertiaTensor(index) * cross(localPoint, impulse));
+}
+
+void BodyStorage::applyImpulse(unsigned int index, vec3 impulse, vec3 localPoint) {
+
+    vec3 linearDelta = this->invMass[index] * impulse;
+    vec3 angularDelta = getWorldInvInertiaTensor(index) * cross(localPoint, impulse);
+
+    linearVelocityX[index] += linearDelta.x;
+    linearVelocityY[index] += linearDelta.y;
+    linearVelocityZ[index] += linearDelta.z;
+
+    angularVelocityX[index] += angularDelta.x;
+    angularVelocityY[index] += angularDelta.y;
+    angularVelocityZ[index] += angularDelta.z;
+}
+
+const vec3 BodyStorage::getVelocityAt(unsigned int index, vec3 localPoint) const {
+    return getLinearVelocity(index) + cross(getAngularVelocity(index), localPoint);
+}
+
+float BodyStorage::calcInvEffectiveMass(unsigned int index, vec3 localPoint, vec3 direction) const {
+
+    vec3 angular = getWorldInvInertiaTensor(index) * cross(localPoint, direction);
+
+    return this->invMass[index] + dot(direction, cross(angular, localPoint));
+}
+
+unsigned int BodyStorage::getStateArrayCount() {
+    return FLOAT_ARRAY_COUNT;
+}
+
+void BodyStorage::saveState(unsigned char* floatArrays, unsigned int stride, unsigned char* awake) const {
+
+    unsigned int count = this->size();
+    if (count == 0)
+        return;
+
+    for (unsigned int arrayIndex = 0; arrayIndex < FLOAT_ARRAY_COUNT; arrayIndex++)
+        memcpy(floatArrays + arrayIndex * stride, (this->*FLOAT_ARRAYS[arrayIndex]).data(), count * sizeof(float));
+
+    memcpy(awake, this->awake.data(), count);
+}
+
+void BodyStorage::loadState(unsigned int count, const unsigned char* floatArrays, unsigned int stride,
+                            const unsigned char* awake) {
+
+    clear();
+    if (count == 0)
+        return;
+
+    for (unsigned int arrayIndex = 0; arrayIndex < FLOAT_ARRAY_COUNT; arrayIndex++) {
+        AlignedArray<float>& array = this->*FLOAT_ARRAYS[arrayIndex];
+        array.resize(count);
+        memcpy(array.data(), floatArrays + arrayIndex * stride, count * sizeof(float));
+    }
+
+    this->awake.resize(count);
+    memcpy(this->awake.data(), awake, count);
+
+    for (unsigned int index = 0; index < count; index++)
+        if (!this->awake[index])
+            sleepingCount++;
+
+    rotation.resize(count);
+    worldInvInertiaTensor.resize(count);
+    dirtyFlags.resize(count);
+    memset(dirtyFlags.data(), ALL_DIRTY, count);
+}
+
+uint64_t BodyStorage::calcStateHash(uint64_t hash) const {
+
+    unsigned int count = this->size();
+
+    for (unsigned int arrayIndex = 0; arrayIndex < FLOAT_ARRAY_COUNT; arrayIndex++)
+        hash = hashStateWords(hash, (this->*FLOAT_ARRAYS[arrayIndex]).data(), count);
+
+    return hashStateBytes(hash, this->awake.data(), count);
+}
+
+void BodyStorage::loadFromState(unsigned int index, SerializedCube cubeState, SerializedPhysics physicsState) {
+
+    positionX[index] = cubeState.position.x;
+    positionY[index] = cubeState.position.y;
+    positionZ[index] = cubeState.position.z;
+
+    quat orientation = normalize(quat_cast(cubeState.rotation));
+
+    orientationX[index] = orientation.x;
+    orientationY[index] = orientation.y;
+    orientationZ[index] = orientation.z;
+    orientationW[index] = orientation.w;
+
+    setVelocity(index, physicsState.linearVelocity, physicsState.angularVelocity);
+
+    markDirty(index);
+}
+
+void BodyStorage::saveToState(unsigned int index, SerializedCube* cubeState, SerializedPhysics* physicsState) {
+
+    cubeState->position = getPosition(index);
+    cubeState->rotation = getRotation(index);
+
+    physicsState->linearVelocity = getLinearVelocity(index);
+    physicsState->angularVelocity = getAngularVelocity(index);
+}
@@ -0,0 +1,146 @@
+#ifndef PHYSICSTEST_BODY_STORAGE_H
+#define PHYSICSTEST_BODY_STORAGE_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "Aabb.h"
+#include "AlignedArray.h"
+#include "Cube.h"
+#include "IntegrationKernel.h"
+#include "Narrowphase.h"
+
+using namespace glm;
+using namespace std;
+
+struct SerializedPhysics {
+    vec3 linearVelocity, angularVelocity;
+};
+
+// state of all dynamic bodies in structure-of-arrays layout,
+// every component lives in its own aligned array so the per-step passes
+// (gravity, integration, damping) are linear streams over memory
+class BodyStorage {
+public:
+    static constexpr float RESTITUTION = 0.0f;
+    static constexpr float FRICTION = 1.0f;
+private:
+    AlignedArray<float> positionX, positionY, positionZ;
+    AlignedArray<float> orientationX, orientationY, orientationZ, orientationW;
+    AlignedArray<float> linearVelocityX, linearVelocityY, linearVelocityZ;
+    AlignedArray<float> angularVelocityX, angularVelocityY, angularVelocityZ;
+    AlignedArray<float> sizeX, sizeY, sizeZ;
+
+    AlignedArray<float> invMass;
+    AlignedArray<float> localInvInertiaX, localInvInertiaY, localInvInertiaZ;
+
+    // how long the body has been slow enough to sleep
+    AlignedArray<float> sleepTime;
+    // sleeping bodies hold zero velocity and are skipped by gravity, integration and bounds updates
+    AlignedArray<unsigned char> awake;
+    unsigned int sleepingCount;
+
+    // derived from the orientation on first use after it changes
+    enum DerivedFlags {
+        ROTATION_DIRTY = 1,
+        INERTIA_DIRTY = 2,
+        ALL_DIRTY = ROTATION_DIRTY | INERTIA_DIRTY
+    };
+
+    mutable AlignedArray<mat3> rotation, worldInvInertiaTensor;
+    mutable AlignedArray<unsigned char> dirtyFlags;
+
+    // the sleepers' orientations across an integration pass, which renormalizes every quaternion it streams over
+    vector<unsigned int> sleeperIndices;
+    vector<quat> sleeperOrientations;
+
+    static AlignedArray<float> BodyStorage::* const FLOAT_ARRAYS[];
+    static const unsigned int FLOAT_ARRAY_COUNT;
+
+    const IntegrationKernel* kernel;
+
+    IntegrationStreams getStreams();
+
+    void markDirty(unsigned int index);
+
+    void integrateTransforms(unsigned int index, vec3 positionDelta, vec3 rotationDelta);
+public:
+    BodyStorage();
+
+    unsigned int add(vec3 position, quat orientation, vec3 size, float mass);
+    // moves the last body into the index and shrinks the storage by one
+    void remove(unsigned int index);
+    void clear();
+
+    void reserve(unsigned int bodyCount);
+    unsigned int size() const;
+
+    const vec3 getPosition(unsigned int index) const;
+    const quat getOrientation(unsigned int index) const;
+    const mat3 getRotation(unsigned int index) const;
+    const mat3 getWorldInvInertiaTensor(unsigned int index) const;
+    const vec3 getSize(unsigned int index) const;
+
+    const vec3 getLinearVelocity(unsigned int index) const;
+    const vec3 getAngularVelocity(unsigned int index) const;
+
+    void setVelocity(unsigned int index, vec3 linearVelocity, vec3 angularVelocity);
+    void setPosition(unsigned int index, vec3 position);
+
+    bool isAwake(unsigned int index) const;
+    // putting a body to sleep stops it, waking it restarts its sleep timer
+    void setAwake(unsigned int index, bool awake);
+    void wakeAll();
+    unsigned int getSleepingCount() const;
+
+    float getSleepTime(unsigned int index) const;
+    void setSleepTime(unsigned int index, float time);
+
+    const vec3 getVelocityAt(unsigned int index, vec3 localPoint) const;
+    // inverse of the mass the body opposes to an impulse along the direction at the point
+    float calcInvEffectiveMass(unsigned int index, vec3 localPoint, vec3 direction) const;
+
+    static const unsigned int POINTS_COUNT = Cube::POINTS_COUNT;
+    void calcPoints(unsigned int index, vec3* points) const;
+
+    const Aabb getAabb(unsigned int index) const;
+    // leaves the boxes of sleeping bodies as they were
+    void calcAabbs(Aabb* aabbs) const;
+
+    const OrientedBox getBox(unsigned int index) const;
+
+    // defaults to the best kernel for this CPU
+    void setIntegrationKernel(const IntegrationKernel& kernel);
+
+    // largest distance an awake body's corners cover in dt once gravity has been applied,
+    // in units of that body's smallest dimension
+    float calcMaxRelativeTravel(vec3 gravity, double dt) const;
+
+    void applyGravity(vec3 gravity, double dt);
+    void applyDamping(double dt, float damping);
+    void integrate(double dt);
+
+    void applyPseudoImpulse(unsigned int index, vec3 impulse, vec3 localPoint);
+    void applyImpulse(unsigned int index, vec3 impulse, vec3 localPoint);
+
+    // float components a snapshot holds per body, see saveState
+    static unsigned int getStateArrayCount();
+    // copies every float component into its own array of size() floats, stride bytes apart, and the awake flags,
+    // which with the sizes and inertias is all there is to a body
+    void saveState(unsigned char* floatArrays, unsigned int stride, unsigned char* awake) const;
+    // replaces all bodies with the ones saved by saveState
+    void loadState(unsigned int count, const unsigned char* floatArrays, unsigned int stride,
+                   const unsigned char* awake);
+
+    // continues hash over the bits of everything saveState saves, in the same order
+    uint64_t calcStateHash(uint64_t hash) const;
+
+    void loadFromState(unsigned int index, SerializedCube cubeState, SerializedPhysics physicsState);
+    void saveToState(unsigned int index, SerializedCube* cubeState, SerializedPhysics* physicsState);
+};
+
+#endif //PHYSICSTEST_BODY_STORAGE_H
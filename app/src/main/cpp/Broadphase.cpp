@@ -0,0 +1,19 @@
+#include "Broadphase.h"
+
+#include "SweepAndPruneBroadphase.h"
+#include "AabbTreeBroadphase.h"
+#include "UniformGridBroadphase.h"
+
+Broadphase* createBroadphase(BroadphaseType type, const Aabb& bounds) {
+
+    switch (type) {
+        case SweepAndPrune:
+            return new SweepAndPruneBroadphase();
+        case AabbTree:
+            return new AabbTreeBroadphase();
+        case UniformGrid:
+            return new UniformGridBroadphase(bounds);
+        default:
+            return nullptr;
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef PHYSICSTEST_BROADPHASE_H
+#define PHYSICSTEST_BROADPHASE_H
+
+#include <vector>
+
+#include "Aabb.h"
+
+using namespace std;
+
+// two bodies whose bounding boxes overlap, dense body indices with a < b
+struct BodyPair {
+    unsigned int a, b;
+};
+
+enum BroadphaseType {
+    SweepAndPrune,
+    AabbTree,
+    UniformGrid
+};
+
+// finds candidate pairs for the narrowphase,
+// implementations may keep state between steps to exploit frame coherence
+class Broadphase {
+public:
+    virtual ~Broadphase() {}
+
+    virtual const char* getName() const = 0;
+
+    // aabbs are indexed by dense body index, the count may change between steps
+    // (removed bodies are swapped with the last one, so an index may start referring to another body)
+    virtual void update(const Aabb* aabbs, unsigned int count) = 0;
+
+    // appends every pair whose boxes overlap as of the last update
+    virtual void findPairs(vector<BodyPair>& pairs) = 0;
+
+    // appends every body whose box overlaps the given one as of the last update, in no particular order
+    virtual void query(const Aabb& aabb, vector<unsigned int>& bodies) = 0;
+};
+
+// bounds is the region the bodies are expected to stay in, only the grid depends on it
+Broadphase* createBroadphase(BroadphaseType type, const Aabb& bounds);
+
+#endif //PHYSICSTEST_BROADPHASE_H
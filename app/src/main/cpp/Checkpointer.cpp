@@ -0,0 +1,151 @@
+#include "Checkpointer.h"
+
+#include "assertUtils.h"
+#include "log.h"
+#include "Profiler.h"
+
+#define CHECKPOINTER_TAG "PT_CHECKPOINTER"
+
+Checkpointer::Checkpointer() : storage(nullptr), running(false), pendingBuffer(NO_BUFFER), writingBuffer(NO_BUFFER),
+                               writtenCount(0), skippedCount(0), failedCount(0) {
+
+    pthread_check_error(pthread_mutex_init(&mutex, nullptr));
+    pthread_check_error(pthread_cond_init(&wakeCondition, nullptr));
+}
+
+Checkpointer::~Checkpointer() {
+
+    stop();
+
+    pthread_check_error(pthread_cond_destroy(&wakeCondition));
+    pthread_check_error(pthread_mutex_destroy(&mutex));
+}
+
+void Checkpointer::start(StateStorage* storage, string fileName) {
+
+    if (this->running)
+        return;
+
+    this->storage = storage;
+    this->fileName = fileName;
+
+    this->pendingBuffer = NO_BUFFER;
+    this->writingBuffer = NO_BUFFER;
+    this->writtenCount = 0;
+    this->skippedCount = 0;
+    this->failedCount = 0;
+
+    this->running = true;
+    pthread_check_error(pthread_create(&thread, nullptr, thread_entrypoint, this));
+}
+
+void Checkpointer::stop() {
+
+    pthread_check_error(pthread_mutex_lock(&mutex));
+
+    bool wasRunning = this->running;
+    this->running = false;
+    pthread_check_error(pthread_cond_signal(&wakeCondition));
+
+    pthread_check_error(pthread_mutex_unlock(&mutex));
+
+    if (wasRunning)
+        pthread_check_error(pthread_join(thread, nullptr));
+}
+
+bool Checkpointer::isRunning() {
+    return this->running;
+}
+
+bool Checkpointer::checkpoint(const function<void(vector<unsigned char>&)>& save) {
+
+    pthread_check_error(pthread_mutex_lock(&mutex));
+
+    int freeBuffer = NO_BUFFER;
+    if (this->running)
+        for (int index = 0; index < 2; index++)
+            if (index != this->pendingBuffer && index != this->writingBuffer)
+                freeBuffer = index;
+
+    pthread_check_error(pthread_mutex_unlock(&mutex));
+
+    if (freeBuffer == NO_BUFFER) {
+        this->skippedCount++;
+        return false;
+    }
+
+    // the writer thread never touches a buffer that is neither pending nor being written
+    save(this->buffers[freeBuffer]);
+
+    pthread_check_error(pthread_mutex_lock(&mutex));
+
+    this->pendingBuffer = freeBuffer;
+    pthread_check_error(pthread_cond_signal(&wakeCondition));
+
+    pthread_check_error(pthread_mutex_unlock(&mutex));
+
+    return true;
+}
+
+unsigned int Checkpointer::getWrittenCount() {
+    return this->writtenCount;
+}
+
+unsigned int Checkpointer::getSkippedCount() {
+    return this->skippedCount;
+}
+
+unsigned int Checkpointer::getFailedCount() {
+    return this->failedCount;
+}
+
+// thread
+
+void* Checkpointer::thread_entrypoint(void* opaque) {
+
+    ((Checkpointer*)opaque)->threadLoop();
+    return nullptr;
+}
+
+void Checkpointer::threadLoop() {
+
+    PROFILE_THREAD_NAME("checkpointer");
+
+    pthread_check_error(pthread_mutex_lock(&mutex));
+
+    while (true) {
+
+        while (this->running && this->pendingBuffer == NO_BUFFER)
+            pthread_check_error(pthread_cond_wait(&wakeCondition, &mutex));
+
+        // a stop still lets the last checkpoint out
+        if (this->pendingBuffer == NO_BUFFER)
+            break;
+
+        this->writingBuffer = this->pendingBuffer;
+        this->pendingBuffer = NO_BUFFER;
+
+        pthread_check_error(pthread_mutex_unlock(&mutex));
+
+        bool written;
+        {
+            PROFILE_ZONE("Checkpointer::write");
+
+            const vector<unsigned char>& buffer = this->buffers[this->writingBuffer];
+            written = this->storage->saveBinaryFile(this->fileName, buffer.data(), (unsigned int) buffer.size());
+        }
+
+        if (written)
+            this->writtenCount++;
+        else {
+            this->failedCount++;
+            print_log(ANDROID_LOG_WARN, CHECKPOINTER_TAG, "Can't write %s", this->fileName.c_str());
+        }
+
+        pthread_check_error(pthread_mutex_lock(&mutex));
+
+        this->writingBuffer = NO_BUFFER;
+    }
+
+    pthread_check_error(pthread_mutex_unlock(&mutex));
+}
@@ -0,0 +1,60 @@
+#ifndef PHYSICSTEST_CHECKPOINTER_H
+#define PHYSICSTEST_CHECKPOINTER_H
+
+#include <pthread.h>
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "StateStorage.h"
+
+using namespace std;
+
+// writes checkpoints of the simulation state on its own thread, so whoever steps the physics never waits for storage
+// there are two buffers: while the writer thread saves one, the other is filled by the next checkpoint,
+// and a checkpoint that finds both taken is skipped instead of waiting
+// the storage replaces the file atomically, so a crash mid write leaves the previous checkpoint in place
+class Checkpointer {
+private:
+    static const int NO_BUFFER = -1;
+
+    StateStorage* storage;
+    string fileName;
+
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t wakeCondition;
+    bool running;
+
+    vector<unsigned char> buffers[2];
+    // buffer indices, NO_BUFFER when there is none
+    int pendingBuffer, writingBuffer;
+
+    std::atomic<unsigned int> writtenCount, skippedCount, failedCount;
+
+    static void* thread_entrypoint(void* opaque);
+    void threadLoop();
+public:
+    Checkpointer();
+    ~Checkpointer();
+
+    Checkpointer(Checkpointer const&) = delete;
+    void operator=(Checkpointer const&) = delete;
+
+    void start(StateStorage* storage, string fileName);
+    // writes the checkpoint still waiting, if any, before it returns
+    void stop();
+    bool isRunning();
+
+    // from one thread at a time, save fills the buffer with the state, false if the checkpoint was skipped
+    bool checkpoint(const function<void(vector<unsigned char>&)>& save);
+
+    // since start, readable from any thread
+    unsigned int getWrittenCount();
+    unsigned int getSkippedCount();
+    unsigned int getFailedCount();
+};
+
+#endif //PHYSICSTEST_CHECKPOINTER_H
@@ -0,0 +1,129 @@
+#include "ContactCache.h"
+
+#include <algorithm>
+
+constexpr float ContactCache::MATCH_DISTANCE;
+
+static bool isPairLess(const BodyPair& first, const BodyPair& second) {
+    return first.a < second.a || (first.a == second.a && first.b < second.b);
+}
+
+void ContactCache::merge(ContactManifold& manifold, const ContactManifold& old) {
+
+    bool taken[ContactManifold::MAX_POINTS] = { };
+
+    for (unsigned int index = 0; index < manifold.pointCount; index++) {
+
+        ContactPoint& point = manifold.points[index];
+
+        // same features first, then the nearest free point: with nearly aligned faces an incident vertex
+        // flips between lying inside a side plane and being clipped by it, which changes its id
+        int match = -1;
+        float matchDistance = MATCH_DISTANCE * MATCH_DISTANCE;
+
+        for (unsigned int oldIndex = 0; oldIndex < old.pointCount; oldIndex++) {
+
+            if (taken[oldIndex])
+                continue;
+
+            const ContactPoint& oldPoint = old.points[oldIndex];
+            if (oldPoint.featureId == point.featureId) {
+                match = oldIndex;
+                break;
+            }
+
+            vec3 delta = oldPoint.position - point.position;
+            float distance = dot(delta, delta);
+            if (distance < matchDistance) {
+                matchDistance = distance;
+                match = oldIndex;
+            }
+        }
+
+        if (match < 0)
+            continue;
+
+        const ContactPoint& oldPoint = old.points[match];
+        taken[match] = true;
+
+        point.normalImpulse = oldPoint.normalImpulse;
+        point.tangentImpulse[0] = oldPoint.tangentImpulse[0];
+        point.tangentImpulse[1] = oldPoint.tangentImpulse[1];
+    }
+}
+
+bool ContactCache::collide(const BodyPair& pair, const BodyStorage& bodies, const Aabb& walls,
+                           ContactManifold& manifold) {
+
+    if (!ContactManifold::isWall(pair.b))
+        return collideBoxes(bodies.getBox(pair.a), bodies.getBox(pair.b), manifold);
+
+    // even walls bound the minimum of their axis, odd ones the maximum
+    unsigned int wall = pair.b - ContactManifold::FIRST_WALL;
+    unsigned int axis = wall / 2;
+
+    vec3 normal = vec3(0);
+    float offset;
+    if (wall % 2 == 0) {
+        normal[axis] = -1;
+        offset = -walls.min[axis];
+    } else {
+        normal[axis] = 1;
+        offset = walls.max[axis];
+    }
+
+    return collideBoxWall(bodies.getBox(pair.a), normal, offset, manifold);
+}
+
+void ContactCache::update(const vector<BodyPair>& pairs, const BodyStorage& bodies, const Aabb& walls) {
+
+    sortedPairs.assign(pairs.begin(), pairs.end());
+    sort(sortedPairs.begin(), sortedPairs.end(), isPairLess);
+
+    manifolds.swap(previous);
+    manifolds.clear();
+
+    unsigned int oldIndex = 0;
+
+    for (const BodyPair& pair : sortedPairs) {
+
+        while (oldIndex < previous.size() && isPairLess({ previous[oldIndex].a, previous[oldIndex].b }, pair))
+            oldIndex++;
+
+        bool hasOld = oldIndex < previous.size() && previous[oldIndex].a == pair.a && previous[oldIndex].b == pair.b;
+
+        // nothing moved, the manifold and its impulses stay as they were when the bodies fell asleep
+        bool asleep = !bodies.isAwake(pair.a) && (ContactManifold::isWall(pair.b) || !bodies.isAwake(pair.b));
+        if (asleep) {
+            if (hasOld)
+                manifolds.push_back(previous[oldIndex]);
+            continue;
+        }
+
+        ContactManifold manifold;
+        if (!collide(pair, bodies, walls, manifold))
+            continue;
+
+        manifold.a = pair.a;
+        manifold.b = pair.b;
+
+        if (hasOld)
+            merge(manifold, previous[oldIndex]);
+
+        manifolds.push_back(manifold);
+    }
+}
+
+void ContactCache::clear() {
+    manifolds.clear();
+    previous.clear();
+}
+
+void ContactCache::setManifolds(const ContactManifold* manifolds, unsigned int count) {
+    this->manifolds.assign(manifolds, manifolds + count);
+    this->previous.clear();
+}
+
+vector<ContactManifold>& ContactCache::getManifolds() {
+    return manifolds;
+}
@@ -0,0 +1,40 @@
+#ifndef PHYSICSTEST_CONTACT_CACHE_H
+#define PHYSICSTEST_CONTACT_CACHE_H
+
+#include <vector>
+
+#include "Broadphase.h"
+#include "BodyStorage.h"
+#include "Narrowphase.h"
+
+using namespace std;
+
+// contact manifolds that persist between steps, one per touching pair
+// manifolds are kept sorted by pair, so last step's manifold is found with a merge instead of a lookup,
+// and points matching by feature id (or lying close to an old point) carry their impulses over
+// pairs of sleeping bodies skip the narrowphase and keep their manifold unchanged
+class ContactCache {
+private:
+    // how far a point may move between steps and still count as the same contact
+    static constexpr float MATCH_DISTANCE = 0.02f;
+
+    vector<ContactManifold> manifolds, previous;
+    vector<BodyPair> sortedPairs;
+
+    void merge(ContactManifold& manifold, const ContactManifold& old);
+
+    static bool collide(const BodyPair& pair, const BodyStorage& bodies, const Aabb& walls,
+                        ContactManifold& manifold);
+public:
+    // runs the narrowphase for every candidate pair, pairs with a wall in b are tested against its plane
+    void update(const vector<BodyPair>& pairs, const BodyStorage& bodies, const Aabb& walls);
+    // drops all manifolds, needed when body indices get reassigned
+    void clear();
+    // puts back manifolds taken from getManifolds, they keep warm starting the next step,
+    // sorted by pair with a < b and every pair once, the way update leaves them
+    void setManifolds(const ContactManifold* manifolds, unsigned int count);
+
+    vector<ContactManifold>& getManifolds();
+};
+
+#endif //PHYSICSTEST_CONTACT_CACHE_H
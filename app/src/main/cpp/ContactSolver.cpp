@@ -0,0 +1,449 @@
+#include "ContactSolver.h"
+
+#include <algorithm>
+
+constexpr float ContactSolver::POSITION_CORRECTION;
+constexpr float ContactSolver::PENETRATION_SLOP;
+constexpr float ContactSolver::MAX_POSITION_CORRECTION;
+
+// walls have no velocity and take no impulse
+
+static vec3 getVelocityAt(const BodyStorage& bodies, unsigned int index, vec3 localPoint) {
+    return ContactManifold::isWall(index) ? vec3(0) : bodies.getVelocityAt(index, localPoint);
+}
+
+static float calcInvEffectiveMass(const BodyStorage& bodies, unsigned int index, vec3 localPoint, vec3 direction) {
+    return ContactManifold::isWall(index) ? 0.0f : bodies.calcInvEffectiveMass(index, localPoint, direction);
+}
+
+static void applyImpulse(BodyStorage& bodies, unsigned int index, vec3 impulse, vec3 localPoint) {
+    if (!ContactManifold::isWall(index))
+        bodies.applyImpulse(index, impulse, localPoint);
+}
+
+static void applyPseudoImpulse(BodyStorage& bodies, unsigned int index, vec3 impulse, vec3 localPoint) {
+    if (!ContactManifold::isWall(index))
+        bodies.applyPseudoImpulse(index, impulse, localPoint);
+}
+
+static vec3 toLocalAnchor(const BodyStorage& bodies, unsigned int index, vec3 point) {
+    return ContactManifold::isWall(index) ? point :
+           transpose(bodies.getRotation(index)) * (point - bodies.getPosition(index));
+}
+
+static vec3 toWorldAnchor(const BodyStorage& bodies, unsigned int index, vec3 anchor) {
+    return ContactManifold::isWall(index) ? anchor :
+           bodies.getPosition(index) + bodies.getRotation(index) * anchor;
+}
+
+ContactSolver::ContactSolver() : jobs(nullptr), velocityIterations(DEFAULT_VELOCITY_ITERATIONS),
+                                 positionIterations(DEFAULT_POSITION_ITERATIONS), warmStarting(true) {
+
+}
+
+void ContactSolver::setVelocityIterations(unsigned int iterations) {
+    this->velocityIterations = iterations;
+}
+
+unsigned int ContactSolver::getVelocityIterations() const {
+    return velocityIterations;
+}
+
+void ContactSolver::setPositionIterations(unsigned int iterations) {
+    this->positionIterations = iterations;
+}
+
+unsigned int ContactSolver::getPositionIterations() const {
+    return positionIterations;
+}
+
+void ContactSolver::setWarmStarting(bool enabled) {
+    this->warmStarting = enabled;
+}
+
+bool ContactSolver::isWarmStarting() const {
+    return warmStarting;
+}
+
+void ContactSolver::setJobSystem(JobSystem* jobs) {
+    this->jobs = jobs;
+}
+
+void ContactSolver::prepare(vector<ContactManifold>& manifolds, const vector<unsigned int>& indices,
+                            unsigned int begin, unsigned int end, const BodyStorage& bodies, float dt) {
+
+    for (unsigned int order = begin; order < end; order++) {
+
+        const ContactManifold& manifold = manifolds[indices[order]];
+        PointConstraint* pointConstraints = &constraints[order * ContactManifold::MAX_POINTS];
+
+        vec3 positionA = bodies.getPosition(manifold.a);
+        vec3 positionB = ContactManifold::isWall(manifold.b) ? vec3(0) : bodies.getPosition(manifold.b);
+
+        for (unsigned int pointIndex = 0; pointIndex < manifold.pointCount; pointIndex++) {
+
+            PointConstraint& constraint = pointConstraints[pointIndex];
+            vec3 position = manifold.points[pointIndex].position;
+            float penetration = manifold.points[pointIndex].penetration;
+
+            constraint.localPointA = position - positionA;
+            constraint.localPointB = position - positionB;
+
+            // the surface of a reaches into b along the normal by half the penetration, and the other way round
+            constraint.anchorA = toLocalAnchor(bodies, manifold.a, position + manifold.normal * (penetration * 0.5f));
+            constraint.anchorB = toLocalAnchor(bodies, manifold.b, position - manifold.normal * (penetration * 0.5f));
+
+            constraint.normalMass = 1.0f / (
+                    calcInvEffectiveMass(bodies, manifold.a, constraint.localPointA, manifold.normal) +
+                    calcInvEffectiveMass(bodies, manifold.b, constraint.localPointB, manifold.normal));
+
+            for (unsigned int tangentIndex = 0; tangentIndex < 2; tangentIndex++) {
+                vec3 tangent = manifold.tangents[tangentIndex];
+                constraint.tangentMass[tangentIndex] = 1.0f / (
+                        calcInvEffectiveMass(bodies, manifold.a, constraint.localPointA, tangent) +
+                        calcInvEffectiveMass(bodies, manifold.b, constraint.localPointB, tangent));
+            }
+
+            constraint.approachVelocity = penetration < 0 ? -penetration / dt : 0.0f;
+        }
+    }
+}
+
+void ContactSolver::warmStart(vector<ContactManifold>& manifolds, const vector<unsigned int>& indices,
+                              unsigned int begin, unsigned int end, BodyStorage& bodies) {
+
+    for (unsigned int order = begin; order < end; order++) {
+
+        ContactManifold& manifold = manifolds[indices[order]];
+        const PointConstraint* pointConstraints = &constraints[order * ContactManifold::MAX_POINTS];
+
+        for (unsigned int pointIndex = 0; pointIndex < manifold.pointCount; pointIndex++) {
+
+            ContactPoint& point = manifold.points[pointIndex];
+            const PointConstraint& constraint = pointConstraints[pointIndex];
+
+            if (!warmStarting) {
+                point.normalImpulse = 0;
+                point.tangentImpulse[0] = 0;
+                point.tangentImpulse[1] = 0;
+                continue;
+            }
+
+            vec3 impulse = manifold.normal * point.normalImpulse +
+                           manifold.tangents[0] * point.tangentImpulse[0] +
+                           manifold.tangents[1] * point.tangentImpulse[1];
+
+            applyImpulse(bodies, manifold.a, -impulse, constraint.localPointA);
+            applyImpulse(bodies, manifold.b, impulse, constraint.localPointB);
+        }
+    }
+}
+
+void ContactSolver::solveVelocityIteration(vector<ContactManifold>& manifolds, const vector<unsigned int>& indices,
+                                           unsigned int begin, unsigned int end, BodyStorage& bodies) {
+
+    for (unsigned int order = begin; order < end; order++) {
+
+        ContactManifold& manifold = manifolds[indices[order]];
+        const PointConstraint* pointConstraints = &constraints[order * ContactManifold::MAX_POINTS];
+
+        unsigned int a = manifold.a, b = manifold.b;
+
+        for (unsigned int pointIndex = 0; pointIndex < manifold.pointCount; pointIndex++) {
+
+            ContactPoint& point = manifold.points[pointIndex];
+            const PointConstraint& constraint = pointConstraints[pointIndex];
+
+            // friction first, bounded by the normal impulse of the last iteration
+            float maxFriction = BodyStorage::FRICTION * point.normalImpulse;
+
+            for (unsigned int tangentIndex = 0; tangentIndex < 2; tangentIndex++) {
+
+                vec3 tangent = manifold.tangents[tangentIndex];
+                vec3 relativeVelocity = getVelocityAt(bodies, b, constraint.localPointB) -
+                                        getVelocityAt(bodies, a, constraint.localPointA);
+
+                float delta = -dot(relativeVelocity, tangent) * constraint.tangentMass[tangentIndex];
+
+                float oldImpulse = point.tangentImpulse[tangentIndex];
+                point.tangentImpulse[tangentIndex] = glm::clamp(oldImpulse + delta, -maxFriction, maxFriction);
+                delta = point.tangentImpulse[tangentIndex] - oldImpulse;
+
+                applyImpulse(bodies, a, -tangent * delta, constraint.localPointA);
+                applyImpulse(bodies, b, tangent * delta, constraint.localPointB);
+            }
+
+            // the total normal impulse may only push the bodies apart
+            vec3 relativeVelocity = getVelocityAt(bodies, b, constraint.localPointB) -
+                                    getVelocityAt(bodies, a, constraint.localPointA);
+            float normalVelocity = dot(relativeVelocity, manifold.normal);
+
+            float delta;
+            if (constraint.approachVelocity > 0)
+                delta = -(normalVelocity + constraint.approachVelocity) * constraint.normalMass;
+            else
+                delta = -(1.0f + BodyStorage::RESTITUTION) * normalVelocity * constraint.normalMass;
+
+            float oldImpulse = point.normalImpulse;
+            point.normalImpulse = glm::max(oldImpulse + delta, 0.0f);
+            delta = point.normalImpulse - oldImpulse;
+
+            applyImpulse(bodies, a, -manifold.normal * delta, constraint.localPointA);
+            applyImpulse(bodies, b, manifold.normal * delta, constraint.localPointB);
+        }
+    }
+}
+
+float ContactSolver::solvePositionIteration(const vector<ContactManifold>& manifolds,
+                                            const vector<unsigned int>& indices,
+                                            unsigned int begin, unsigned int end, BodyStorage& bodies) {
+
+    float maxPenetration = 0;
+
+    for (unsigned int order = begin; order < end; order++) {
+
+        const ContactManifold& manifold = manifolds[indices[order]];
+        const PointConstraint* pointConstraints = &constraints[order * ContactManifold::MAX_POINTS];
+
+        unsigned int a = manifold.a, b = manifold.b;
+        vec3 normal = manifold.normal;
+
+        for (unsigned int pointIndex = 0; pointIndex < manifold.pointCount; pointIndex++) {
+
+            const PointConstraint& constraint = pointConstraints[pointIndex];
+
+            vec3 pointA = toWorldAnchor(bodies, a, constraint.anchorA);
+            vec3 pointB = toWorldAnchor(bodies, b, constraint.anchorB);
+
+            float penetration = dot(pointA - pointB, normal);
+            maxPenetration = glm::max(maxPenetration, penetration);
+
+            float error = penetration - PENETRATION_SLOP;
+            if (error <= 0)
+                continue;
+
+            // the bodies have moved since prepare, so do the arms and the mass
+            vec3 position = (pointA + pointB) * 0.5f;
+            vec3 localPointA = position - bodies.getPosition(a);
+            vec3 localPointB = ContactManifold::isWall(b) ? vec3(0) : position - bodies.getPosition(b);
+
+            float invMass = calcInvEffectiveMass(bodies, a, localPointA, normal) +
+                            calcInvEffectiveMass(bodies, b, localPointB, normal);
+
+            float correction = glm::min(error * POSITION_CORRECTION, MAX_POSITION_CORRECTION) / invMass;
+
+            applyPseudoImpulse(bodies, a, -normal * correction, localPointA);
+            applyPseudoImpulse(bodies, b, normal * correction, localPointB);
+        }
+    }
+
+    return maxPenetration;
+}
+
+void ContactSolver::solveGroupVelocities(vector<ContactManifold>& manifolds, const vector<unsigned int>& indices,
+                                         unsigned int begin, unsigned int end, BodyStorage& bodies, float dt) {
+
+    prepare(manifolds, indices, begin, end, bodies, dt);
+    warmStart(manifolds, indices, begin, end, bodies);
+
+    for (unsigned int iteration = 0; iteration < velocityIterations; iteration++)
+        solveVelocityIteration(manifolds, indices, begin, end, bodies);
+}
+
+void ContactSolver::solveGroupPositions(const vector<ContactManifold>& manifolds, const vector<unsigned int>& indices,
+                                        unsigned int begin, unsigned int end, BodyStorage& bodies) {
+
+    for (unsigned int iteration = 0; iteration < positionIterations; iteration++)
+        if (solvePositionIteration(manifolds, indices, begin, end, bodies) < 3.0f * PENETRATION_SLOP)
+            break;
+}
+
+void ContactSolver::buildBatches(const vector<unsigned int>& groupOffsets) {
+
+    // depends only on the groups, never on the thread count
+    batches.clear();
+    colouredGroups.clear();
+
+    unsigned int groupCount = groupOffsets.empty() ? 0 : (unsigned int)groupOffsets.size() - 1;
+    unsigned int batchBegin = 0;
+
+    for (unsigned int group = 0; group < groupCount; group++) {
+
+        if (groupOffsets[group + 1] - groupOffsets[group] >= MIN_COLOURED_MANIFOLDS) {
+            if (batchBegin < group)
+                batches.push_back({ batchBegin, group });
+            colouredGroups.push_back({ groupOffsets[group], groupOffsets[group + 1], 0, 0 });
+            batchBegin = group + 1;
+        } else if (groupOffsets[group + 1] - groupOffsets[batchBegin] >= MIN_BATCH_MANIFOLDS || group + 1 == groupCount) {
+            batches.push_back({ batchBegin, group + 1 });
+            batchBegin = group + 1;
+        }
+    }
+}
+
+void ContactSolver::runBatches(const function<void(unsigned int)>& job) {
+
+    unsigned int batchCount = (unsigned int)batches.size();
+
+    if (jobs != nullptr) {
+        jobs->parallelFor(batchCount, job);
+    } else {
+        for (unsigned int batch = 0; batch < batchCount; batch++)
+            job(batch);
+    }
+}
+
+void ContactSolver::colourGroup(const vector<ContactManifold>& manifolds, ColouredGroup& group) {
+
+    // greedy, in island order: every manifold takes the lowest colour neither of its bodies has yet,
+    // walls never move so they do not count; manifolds finding all colours taken go to the serial colour
+    unsigned int counts[MAX_COLOURS + 1] = { };
+    manifoldColours.resize(group.end - group.begin);
+
+    for (unsigned int position = group.begin; position < group.end; position++) {
+
+        const ContactManifold& manifold = manifolds[solveIndices[position]];
+        bool wall = ContactManifold::isWall(manifold.b);
+
+        unsigned long long used = bodyColours[manifold.a] | (wall ? 0 : bodyColours[manifold.b]);
+
+        unsigned int colour = MAX_COLOURS;
+        if (~used != 0) {
+            colour = (unsigned int)__builtin_ctzll(~used);
+            bodyColours[manifold.a] |= 1ULL << colour;
+            if (!wall)
+                bodyColours[manifold.b] |= 1ULL << colour;
+        }
+
+        manifoldColours[position - group.begin] = colour;
+        counts[colour]++;
+    }
+
+    for (unsigned int position = group.begin; position < group.end; position++) {
+        const ContactManifold& manifold = manifolds[solveIndices[position]];
+        bodyColours[manifold.a] = 0;
+        if (!ContactManifold::isWall(manifold.b))
+            bodyColours[manifold.b] = 0;
+    }
+
+    // counting sort of the group's manifolds by colour
+    unsigned int offsets[MAX_COLOURS + 1];
+    unsigned int offset = group.begin;
+
+    group.firstColour = (unsigned int)colours.size();
+
+    for (unsigned int colour = 0; colour <= MAX_COLOURS; colour++) {
+        offsets[colour] = offset;
+        if (counts[colour] > 0)
+            colours.push_back({ offset, offset + counts[colour], colour == MAX_COLOURS });
+        offset += counts[colour];
+    }
+
+    group.colourCount = (unsigned int)colours.size() - group.firstColour;
+
+    sortedIndices.resize(group.end - group.begin);
+    for (unsigned int position = group.begin; position < group.end; position++)
+        sortedIndices[offsets[manifoldColours[position - group.begin]]++ - group.begin] = solveIndices[position];
+
+    copy(sortedIndices.begin(), sortedIndices.end(), solveIndices.begin() + group.begin);
+}
+
+void ContactSolver::runColour(const ColourRange& colour, const function<void(unsigned int, unsigned int)>& job) {
+
+    // manifolds of one colour share no body, so their chunks can run on any thread in any order
+    if (colour.serial || jobs == nullptr) {
+        job(colour.begin, colour.end);
+        return;
+    }
+
+    unsigned int chunkCount = (colour.end - colour.begin + COLOUR_CHUNK_MANIFOLDS - 1) / COLOUR_CHUNK_MANIFOLDS;
+
+    jobs->parallelFor(chunkCount, [&](unsigned int chunk) {
+        unsigned int begin = colour.begin + chunk * COLOUR_CHUNK_MANIFOLDS;
+        job(begin, std::min(begin + COLOUR_CHUNK_MANIFOLDS, colour.end));
+    });
+}
+
+void ContactSolver::solveColouredVelocities(vector<ContactManifold>& manifolds, const ColouredGroup& group,
+                                            BodyStorage& bodies, float dt) {
+
+    // prepare reads the lazily derived inertia of both bodies, so it goes colour by colour as well
+    for (unsigned int colour = group.firstColour; colour < group.firstColour + group.colourCount; colour++)
+        runColour(colours[colour], [&](unsigned int begin, unsigned int end) {
+            prepare(manifolds, solveIndices, begin, end, bodies, dt);
+            warmStart(manifolds, solveIndices, begin, end, bodies);
+        });
+
+    for (unsigned int iteration = 0; iteration < velocityIterations; iteration++)
+        for (unsigned int colour = group.firstColour; colour < group.firstColour + group.colourCount; colour++)
+            runColour(colours[colour], [&](unsigned int begin, unsigned int end) {
+                solveVelocityIteration(manifolds, solveIndices, begin, end, bodies);
+            });
+}
+
+void ContactSolver::solveColouredPositions(const vector<ContactManifold>& manifolds, const ColouredGroup& group,
+                                           BodyStorage& bodies) {
+
+    for (unsigned int iteration = 0; iteration < positionIterations; iteration++) {
+
+        float maxPenetration = 0;
+
+        for (unsigned int colour = group.firstColour; colour < group.firstColour + group.colourCount; colour++) {
+
+            const ColourRange& range = colours[colour];
+
+            // one slot per chunk, the maximum does not depend on which chunk finishes first
+            chunkPenetrations.assign((range.end - range.begin + COLOUR_CHUNK_MANIFOLDS - 1) / COLOUR_CHUNK_MANIFOLDS, 0.0f);
+
+            runColour(range, [&](unsigned int begin, unsigned int end) {
+                chunkPenetrations[(begin - range.begin) / COLOUR_CHUNK_MANIFOLDS] =
+                        solvePositionIteration(manifolds, solveIndices, begin, end, bodies);
+            });
+
+            for (float penetration : chunkPenetrations)
+                maxPenetration = glm::max(maxPenetration, penetration);
+        }
+
+        if (maxPenetration < 3.0f * PENETRATION_SLOP)
+            break;
+    }
+}
+
+void ContactSolver::solveVelocities(vector<ContactManifold>& manifolds, const vector<unsigned int>& indices,
+                                    const vector<unsigned int>& groupOffsets, BodyStorage& bodies, float dt) {
+
+    solveIndices.assign(indices.begin(), indices.end());
+    solveGroupOffsets.assign(groupOffsets.begin(), groupOffsets.end());
+    constraints.resize(indices.size() * ContactManifold::MAX_POINTS);
+
+    buildBatches(groupOffsets);
+
+    colours.clear();
+    bodyColours.resize(bodies.size(), 0);
+    for (ColouredGroup& group : colouredGroups)
+        colourGroup(manifolds, group);
+
+    runBatches([&](unsigned int batch) {
+        for (unsigned int group = batches[batch].firstGroup; group < batches[batch].endGroup; group++)
+            solveGroupVelocities(manifolds, solveIndices, groupOffsets[group], groupOffsets[group + 1], bodies, dt);
+    });
+
+    for (const ColouredGroup& group : colouredGroups)
+        solveColouredVelocities(manifolds, group, bodies, dt);
+}
+
+void ContactSolver::solvePositions(const vector<ContactManifold>& manifolds, BodyStorage& bodies) {
+
+    runBatches([&](unsigned int batch) {
+        for (unsigned int group = batches[batch].firstGroup; group < batches[batch].endGroup; group++)
+            solveGroupPositions(manifolds, solveIndices, solveGroupOffsets[group], solveGroupOffsets[group + 1],
+                                bodies);
+    });
+
+    for (const ColouredGroup& group : colouredGroups)
+        solveColouredPositions(manifolds, group, bodies);
+}
+
+unsigned int ContactSolver::getColourCount() const {
+    return (unsigned int)colours.size();
+}
@@ -0,0 +1,147 @@
+#ifndef PHYSICSTEST_CONTACT_SOLVER_H
+#define PHYSICSTEST_CONTACT_SOLVER_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "BodyStorage.h"
+#include "JobSystem.h"
+#include "Narrowphase.h"
+
+using namespace glm;
+using namespace std;
+
+// sequential impulse solver for box contacts, walls included as static bodies
+// impulses are accumulated per point and clamped as a total rather than per iteration,
+// and with warm starting the totals from the last step (kept by the contact cache) are applied
+// up front, so a resting pile starts each step already close to its solution
+// the velocity pass runs before integration, the position pass after it: penetration is measured
+// again from the moved bodies on every position iteration and pushed out without adding velocity
+// groups of manifolds that share no body (islands) are solved as separate jobs; a group always runs
+// start to finish on one thread, so the result does not depend on the thread count
+// a single large island (a pile) is graph coloured instead: manifolds of one colour share no body,
+// so every colour is split into chunks across the threads, and colours are solved one after another;
+// whether an island is coloured depends only on its size, again keeping the result independent of threads
+class ContactSolver {
+private:
+    static const unsigned int DEFAULT_VELOCITY_ITERATIONS = 8;
+    static const unsigned int DEFAULT_POSITION_ITERATIONS = 3;
+    // share of the penetration removed per position iteration
+    static constexpr float POSITION_CORRECTION = 0.2f;
+    // penetration left alone, keeps resting contacts touching instead of being pushed apart every step
+    static constexpr float PENETRATION_SLOP = 0.005f;
+    // limits the push a single point gets, deep overlaps are resolved over several steps
+    static constexpr float MAX_POSITION_CORRECTION = 0.2f;
+    // small groups are batched into jobs of at least this many manifolds
+    static const unsigned int MIN_BATCH_MANIFOLDS = 32;
+    // groups at least this large are coloured
+    static const unsigned int MIN_COLOURED_MANIFOLDS = 256;
+    static const unsigned int COLOUR_CHUNK_MANIFOLDS = 64;
+    // one bit per colour in a body mask, manifolds beyond that share a final colour solved on one thread
+    static const unsigned int MAX_COLOURS = 64;
+
+    struct PointConstraint {
+        // from the body positions to the contact point, fixed for the velocity pass
+        vec3 localPointA, localPointB;
+        // the touching points of both surfaces in body space, world space for walls
+        vec3 anchorA, anchorB;
+        float normalMass;
+        float tangentMass[2];
+        // normal velocity the points may still approach with, nonzero for speculative points
+        float approachVelocity;
+    };
+
+    struct Batch {
+        unsigned int firstGroup, endGroup;
+    };
+
+    struct ColouredGroup {
+        unsigned int begin, end;
+        unsigned int firstColour, colourCount;
+    };
+
+    struct ColourRange {
+        unsigned int begin, end;
+        bool serial;
+    };
+
+    // the indices being solved, coloured groups reordered by colour; constraints follow this order
+    vector<unsigned int> solveIndices;
+    vector<unsigned int> solveGroupOffsets;
+    vector<PointConstraint> constraints;
+
+    // every batch of small groups is one job
+    vector<Batch> batches;
+    vector<ColouredGroup> colouredGroups;
+    vector<ColourRange> colours;
+
+    // scratch for colouring
+    vector<unsigned long long> bodyColours;
+    vector<unsigned int> manifoldColours;
+    vector<unsigned int> sortedIndices;
+    vector<float> chunkPenetrations;
+
+    JobSystem* jobs;
+
+    unsigned int velocityIterations;
+    unsigned int positionIterations;
+    bool warmStarting;
+
+    // all of these work on the manifolds at indices[begin] .. indices[end - 1]
+    void prepare(vector<ContactManifold>& manifolds, const vector<unsigned int>& indices,
+                 unsigned int begin, unsigned int end, const BodyStorage& bodies, float dt);
+    void warmStart(vector<ContactManifold>& manifolds, const vector<unsigned int>& indices,
+                   unsigned int begin, unsigned int end, BodyStorage& bodies);
+    void solveVelocityIteration(vector<ContactManifold>& manifolds, const vector<unsigned int>& indices,
+                                unsigned int begin, unsigned int end, BodyStorage& bodies);
+    // returns the deepest penetration found before correcting
+    float solvePositionIteration(const vector<ContactManifold>& manifolds, const vector<unsigned int>& indices,
+                                 unsigned int begin, unsigned int end, BodyStorage& bodies);
+
+    void solveGroupVelocities(vector<ContactManifold>& manifolds, const vector<unsigned int>& indices,
+                              unsigned int begin, unsigned int end, BodyStorage& bodies, float dt);
+    void solveGroupPositions(const vector<ContactManifold>& manifolds, const vector<unsigned int>& indices,
+                             unsigned int begin, unsigned int end, BodyStorage& bodies);
+
+    void buildBatches(const vector<unsigned int>& groupOffsets);
+    // runs the job for every batch, on the job system if there is one
+    void runBatches(const function<void(unsigned int)>& job);
+
+    void colourGroup(const vector<ContactManifold>& manifolds, ColouredGroup& group);
+    // runs the job over chunks of the colour's index range
+    void runColour(const ColourRange& colour, const function<void(unsigned int, unsigned int)>& job);
+    void solveColouredVelocities(vector<ContactManifold>& manifolds, const ColouredGroup& group,
+                                 BodyStorage& bodies, float dt);
+    void solveColouredPositions(const vector<ContactManifold>& manifolds, const ColouredGroup& group,
+                                BodyStorage& bodies);
+public:
+    ContactSolver();
+
+    void setVelocityIterations(unsigned int iterations);
+    unsigned int getVelocityIterations() const;
+
+    // stops early once nothing penetrates deeper than a few times the slop
+    void setPositionIterations(unsigned int iterations);
+    unsigned int getPositionIterations() const;
+
+    void setWarmStarting(bool enabled);
+    bool isWarmStarting() const;
+
+    // null solves everything on the calling thread
+    void setJobSystem(JobSystem* jobs);
+
+    // solves the manifolds at the indices, in that order
+    // groupOffsets splits the indices into groups that share no body, from 0 up to indices.size()
+    // leaves the accumulated impulses in the manifolds for the next step
+    void solveVelocities(vector<ContactManifold>& manifolds, const vector<unsigned int>& indices,
+                         const vector<unsigned int>& groupOffsets, BodyStorage& bodies, float dt);
+    // after integration, solves the indices and groups of the last solveVelocities again,
+    // manifolds has to be the same array that call got
+    void solvePositions(const vector<ContactManifold>& manifolds, BodyStorage& bodies);
+
+    // colours used by the coloured groups of the last solve
+    unsigned int getColourCount() const;
+};
+
+#endif //PHYSICSTEST_CONTACT_SOLVER_H
@@ -0,0 +1,127 @@
+#include "ContinuousCollision.h"
+
+#include <algorithm>
+
+constexpr float ContinuousCollision::FAST_TRAVEL;
+constexpr float ContinuousCollision::SKIN;
+
+vec3 ContinuousCollision::sweepWalls(const OrientedBox& box, vec3 motion, const Aabb& walls) {
+
+    for (unsigned int axis = 0; axis < 3; axis++) {
+
+        if (motion[axis] == 0)
+            continue;
+
+        // half the box's extent along the axis
+        float extent = 0;
+        for (unsigned int column = 0; column < 3; column++)
+            extent += abs(box.rotation[column][axis]) * box.halfSize[column];
+
+        float gap = motion[axis] > 0 ? walls.max[axis] - (box.center[axis] + extent) :
+                                       (box.center[axis] - extent) - walls.min[axis];
+
+        // a box touching the wall already doesn't go any deeper
+        float allowed = std::max(gap - SKIN, 0.0f);
+        if (abs(motion[axis]) > allowed)
+            motion[axis] = motion[axis] > 0 ? allowed : -allowed;
+    }
+
+    return motion;
+}
+
+float ContinuousCollision::sweepBody(vec3 center, float radius, vec3 motion, const OrientedBox& other) {
+
+    // slab test of the sphere's path against the other box grown by the radius, in the other box's space
+    mat3 toLocal = transpose(other.rotation);
+    vec3 origin = toLocal * (center - other.center);
+    vec3 direction = toLocal * motion;
+    vec3 halfSize = other.halfSize + vec3(radius);
+
+    float entry = 0, exit = 1;
+    bool inside = true;
+
+    for (unsigned int axis = 0; axis < 3; axis++) {
+
+        if (abs(origin[axis]) > halfSize[axis])
+            inside = false;
+
+        if (direction[axis] == 0) {
+            if (abs(origin[axis]) > halfSize[axis])
+                return 1.0f;
+            continue;
+        }
+
+        float near = (-halfSize[axis] - origin[axis]) / direction[axis];
+        float far = (halfSize[axis] - origin[axis]) / direction[axis];
+        if (near > far)
+            std::swap(near, far);
+
+        entry = std::max(entry, near);
+        exit = std::min(exit, far);
+        if (entry > exit)
+            return 1.0f;
+    }
+
+    // overlapping already, the contact solver pushes them apart
+    if (inside)
+        return 1.0f;
+
+    return std::max(entry - SKIN / length(motion), 0.0f);
+}
+
+void ContinuousCollision::sweep(const BodyStorage& bodies, const vector<Aabb>& aabbs, Broadphase& broadphase,
+                                const Aabb& walls, double dt) {
+
+    sweeps.clear();
+
+    for (unsigned int index = 0; index < bodies.size(); index++) {
+
+        if (!bodies.isAwake(index))
+            continue;
+
+        vec3 size = bodies.getSize(index);
+        float minSize = std::min(size.x, std::min(size.y, size.z));
+
+        vec3 motion = bodies.getLinearVelocity(index) * (float)dt;
+        if (length(motion) <= FAST_TRAVEL * minSize)
+            continue;
+
+        OrientedBox box = bodies.getBox(index);
+
+        Aabb swept = aabbs[index].merge({ aabbs[index].min + motion, aabbs[index].max + motion });
+        float radius = 0.5f * minSize;
+
+        candidates.clear();
+        broadphase.query(swept, candidates);
+
+        float fraction = 1.0f;
+        for (unsigned int other : candidates)
+            if (other != index)
+                fraction = std::min(fraction, sweepBody(box.center, radius, motion, bodies.getBox(other)));
+
+        vec3 allowed = sweepWalls(box, motion * fraction, walls);
+
+        sweeps.push_back({ index, box.center, allowed, allowed != motion });
+    }
+}
+
+void ContinuousCollision::clampMotion(BodyStorage& bodies) {
+
+    for (const Sweep& sweep : sweeps)
+        if (sweep.clamped)
+            bodies.setPosition(sweep.body, sweep.start + sweep.motion);
+}
+
+unsigned int ContinuousCollision::getSweptCount() {
+    return (unsigned int) sweeps.size();
+}
+
+unsigned int ContinuousCollision::getClampedCount() {
+
+    unsigned int count = 0;
+    for (const Sweep& sweep : sweeps)
+        if (sweep.clamped)
+            count++;
+
+    return count;
+}
@@ -0,0 +1,59 @@
+#ifndef PHYSICSTEST_CONTINUOUS_COLLISION_H
+#define PHYSICSTEST_CONTINUOUS_COLLISION_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "Aabb.h"
+#include "BodyStorage.h"
+#include "Broadphase.h"
+
+using namespace glm;
+using namespace std;
+
+// keeps fast bodies from passing through the walls and through each other within one substep
+// the linear motion of every fast body is swept before integration, and once integrated a body that would hit something
+// is pulled back to just short of the hit, its velocity is left to the contact solver of the next substep
+// against bodies its inscribed sphere is swept against their boxes, which is all it takes to keep it from tunnelling,
+// and the motion is cut at the first hit; the walls are axis aligned, so the box is swept exactly against each of them
+// and only the motion along that axis is cut, the body keeps sliding along the wall
+class ContinuousCollision {
+public:
+    // bodies moving more than this share of their smallest dimension in a substep are swept,
+    // the substep controller keeps everything below it until its budget runs out
+    static constexpr float FAST_TRAVEL = 0.2f;
+private:
+    // distance a swept body stops short of what it hits, well inside the contact margin
+    static constexpr float SKIN = 0.005f;
+
+    struct Sweep {
+        unsigned int body;
+        vec3 start;
+        // what is left of the motion after the sweep
+        vec3 motion;
+        bool clamped;
+    };
+
+    vector<Sweep> sweeps;
+    // bodies the broadphase finds in the swept box of one body
+    vector<unsigned int> candidates;
+
+    // the motion with every component that would take the box through a wall cut short
+    static vec3 sweepWalls(const OrientedBox& box, vec3 motion, const Aabb& walls);
+    // share of the motion the sphere takes before it touches the box
+    static float sweepBody(vec3 center, float radius, vec3 motion, const OrientedBox& other);
+public:
+    // from the velocities the integration is about to apply, aabbs are the current boxes of all bodies
+    // and the broadphase is up to date with them
+    void sweep(const BodyStorage& bodies, const vector<Aabb>& aabbs, Broadphase& broadphase, const Aabb& walls,
+               double dt);
+    // moves the bodies that hit something back to where they hit it
+    void clampMotion(BodyStorage& bodies);
+
+    // bodies swept by the last sweep and how many of them hit something
+    unsigned int getSweptCount();
+    unsigned int getClampedCount();
+};
+
+#endif //PHYSICSTEST_CONTINUOUS_COLLISION_H
@@ -0,0 +1,97 @@
+#include "Cube.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+Cube::Cube(vec3 position, quat orientation, vec3 size) :
+    position(position), orientation(orientation), size(size) {
+    markDirty();
+}
+
+void Cube::markDirty() {
+    rotationDirty = true;
+    pointsDirty = true;
+}
+
+void Cube::calcPoints() const {
+
+    mat3 rotation = getRotation();
+
+    // half extents along the cube axes, the corners are every +/- combination of them
+    vec3 x = rotation[0] * (size.x * 0.5f);
+    vec3 y = rotation[1] * (size.y * 0.5f);
+    vec3 z = rotation[2] * (size.z * 0.5f);
+
+    vec3 xPos = position + x, xNeg = position - x;
+    vec3 yzPP = y + z, yzNP = z - y, yzPN = y - z, yzNN = -(y + z);
+
+    points[0] = xPos + yzPP;
+    points[1] = xPos + yzNP;
+    points[2] = xPos + yzPN;
+    points[3] = xPos + yzNN;
+
+    points[4] = xNeg + yzPP;
+    points[5] = xNeg + yzNP;
+    points[6] = xNeg + yzPN;
+    points[7] = xNeg + yzNN;
+
+    pointsDirty = false;
+}
+
+const vec3 Cube::getPosition() const {
+    return this->position;
+}
+
+const quat Cube::getOrientation() const {
+    return this->orientation;
+}
+
+const mat3 Cube::getRotation() const {
+
+    if (rotationDirty) {
+        rotation = mat3_cast(orientation);
+        rotationDirty = false;
+    }
+
+    return this->rotation;
+}
+
+const vec3 Cube::getSize() const {
+    return this->size;
+}
+
+const vec3* Cube::getPoints() const {
+
+    if (pointsDirty)
+        calcPoints();
+
+    return this->points;
+}
+
+const vec3 Cube::getLeftBottomNear() const {
+    return position - size * 0.5f;
+}
+
+const vec3 Cube::getRightTopFar() const {
+    return position + size * 0.5f;
+}
+
+void Cube::integrateTransforms(vec3 positionDelta, vec3 rotationDelta) {
+
+    this->position += positionDelta;
+
+    quat rotationDeltaQ = quat(0, rotationDelta.x, rotationDelta.y, rotationDelta.z);
+    this->orientation = normalize(orientation + (rotationDeltaQ * orientation) * 0.5f);
+
+    markDirty();
+}
+
+void Cube::loadFromState(SerializedCube state) {
+    this->position = state.position;
+    this->orientation = normalize(quat_cast(state.rotation));
+    markDirty();
+}
+
+void Cube::saveToState(SerializedCube* state) {
+    state->position = this->position;
+    state->rotation = this->getRotation();
+}
@@ -0,0 +1,48 @@
+#ifndef PHYSICSTEST_CUBE_H
+#define PHYSICSTEST_CUBE_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+using namespace glm;
+
+struct SerializedCube {
+    vec3 position;
+    mat3 rotation;
+};
+
+class Cube {
+private:
+    vec3 position;
+    quat orientation;
+    vec3 size;
+
+    // derived from position and orientation on first use after they change
+    mutable mat3 rotation;
+    mutable vec3 points[8];
+    mutable bool rotationDirty, pointsDirty;
+
+    // physics
+    void calcPoints() const;
+    void markDirty();
+public:
+    Cube(vec3 position, quat orientation, vec3 size);
+
+    const vec3 getPosition() const;
+    const quat getOrientation() const;
+    const mat3 getRotation() const;
+    const vec3 getSize() const;
+
+    static const unsigned int POINTS_COUNT = 8;
+    const vec3* getPoints() const;
+
+    const vec3 getLeftBottomNear() const;
+    const vec3 getRightTopFar() const;
+
+    void integrateTransforms(vec3 positionDelta, vec3 rotationDelta);
+
+    void loadFromState(SerializedCube state);
+    void saveToState(SerializedCube* state);
+};
+
+#endif //PHYSICSTEST_CUBE_H
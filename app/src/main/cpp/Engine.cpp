@@ -2,11 +2,15 @@
 
 #include <unistd.h>
 
+#include <algorithm>
+
 #include "log.h"
 #include "exceptionUtils.h"
 
 #include "AssetManager.h"
 #include "Physics.h"
+#include "PhysicsThread.h"
+#include "Profiler.h"
 #include "Render.h"
 #include "InputManager.h"
 
@@ -16,7 +20,7 @@ extern "C" {
 
 #define ENGINE_TAG "PT_ENGINE"
 
-Engine::Engine() : eventQueue(30) {
+Engine::Engine() : eventQueue(30), frameTime(PhysicsThread::STEP_TIME) {
 
 }
 
@@ -67,6 +71,14 @@ void Engine::setOutputWindow(ANativeWindow* window) {
     pushEvent(SetOutputWindow, (void*)window);
 }
 
+void Engine::setRefreshRate(float refreshRate) {
+    pushEvent(SetRefreshRate, (void*)new float(refreshRate));
+}
+
+FrameStatsSummary Engine::getFrameStats() {
+    return frameStats.getSummary();
+}
+
 // thread
 
 void* Engine::thread_entrypoint(void* opaque) {
@@ -77,6 +89,8 @@ void* Engine::thread_entrypoint(void* opaque) {
 
 void Engine::threadLoop() {
 
+    PROFILE_THREAD_NAME("engine");
+
     while (true) {
         processEventsUntilNextTick();
         if (finalized)
@@ -84,21 +98,80 @@ void Engine::threadLoop() {
 
         my_assert(started);
 
+        PROFILE_ZONE("Engine::frame");
+
+        double frameStart = getTime();
+        // woken a little early by the timed wait counts as on time
+        double lateness = std::max(frameStart - nextTickTime, 0.0);
+
+        // the gravity goes to the physics thread, which steps on its own
         InputManager::getInstance().applyUserInput();
-        Physics::getInstance().step(FRAME_TIME);
-        Render::getInstance().draw();
 
-        setNextTickTime();
+        PhysicsThread& physicsThread = PhysicsThread::getInstance();
+        physicsThread.updateSnapshot();
+
+        const PhysicsSnapshot& snapshot = physicsThread.getSnapshot();
+        interpolateRenderStates(snapshot.previous, snapshot.current, physicsThread.getAlpha(frameStart), drawnState);
+
+        double renderStart = getTime();
+        Render::getInstance().draw(drawnState);
+        double renderTime = getTime() - renderStart;
+
+        unsigned int droppedFrames = setNextTickTime();
+        frameStats.addFrame(lateness, renderTime, droppedFrames);
     }
 }
 
-void Engine::setNextTickTime() {
+unsigned int Engine::setNextTickTime() {
 
-    nextTickTime += FRAME_TIME;
+    nextTickTime += frameTime;
 
     double now = getTime();
-    if (now > nextTickTime + FRAME_TIME * MAX_LAG_IN_FRAMES)
+    if (now > nextTickTime + frameTime * MAX_LAG_IN_FRAMES) {
+        // every whole frame the schedule is moved past is one the display never got
+        unsigned int dropped = (unsigned int)((now - nextTickTime) / frameTime);
         nextTickTime = now;
+
+        return dropped;
+    }
+
+    return 0;
+}
+
+void Engine::stopPhysics() {
+
+    PhysicsThread& physicsThread = PhysicsThread::getInstance();
+    if (!physicsThread.isRunning())
+        return;
+
+    physicsThread.stop();
+    saveReplay();
+}
+
+void Engine::saveReplay() {
+
+    if (recorder.getStepCount() == 0)
+        return;
+
+    vector<unsigned char> replay;
+    recorder.save(replay);
+
+    AssetManager::getInstance().getExternalStorage().saveBinaryFile(REPLAY_FILE_NAME, replay.data(),
+                                                                    (unsigned int) replay.size());
+}
+
+void Engine::saveFrameStats() {
+
+    FrameStatsSummary summary = frameStats.getSummary();
+    if (summary.totalFrames == 0)
+        return;
+
+    string json = FrameStats::toJson(summary);
+    AssetManager::getInstance().getExternalStorage().saveBinaryFile(FRAME_STATS_FILE_NAME, json.data(),
+                                                                    (unsigned int) json.size());
+
+    print_log(ANDROID_LOG_INFO, ENGINE_TAG, "Frame stats: %llu frames, %llu dropped, tick lateness p99 %.3f ms",
+              summary.totalFrames, summary.totalDroppedFrames, summary.tickLateness.p99 * 1000.0);
 }
 
 // messages
@@ -143,7 +216,10 @@ void Engine::processEvent(EngineEvent& event) {
             InitStruct* initStruct = (InitStruct*)event.param;
 
             AssetManager::getInstance().initialize(initStruct->nativeAssetManager, initStruct->externalFilesDir);
+            Physics::getInstance().setStorage(&AssetManager::getInstance().getExternalStorage());
             Physics::getInstance().initialize();
+            PhysicsThread::getInstance().setFrameStats(&frameStats);
+            PhysicsThread::getInstance().setRecorder(&recorder);
             Render::getInstance().initialize();
             InputManager::getInstance().initialize();
 
@@ -152,6 +228,11 @@ void Engine::processEvent(EngineEvent& event) {
             break;
         }
         case Finalize:
+            stopPhysics();
+            PhysicsThread::getInstance().setFrameStats(nullptr);
+            PhysicsThread::getInstance().setRecorder(nullptr);
+            // before the asset manager lets go of the external files directory
+            saveFrameStats();
             InputManager::getInstance().finalize();
             Render::getInstance().finalize();
             Physics::getInstance().finalize();
@@ -160,14 +241,27 @@ void Engine::processEvent(EngineEvent& event) {
             break;
         case Start:
             nextTickTime = getTime();
+            // no catching up on the time spent stopped
+            PhysicsThread::getInstance().start();
             started = true;
             break;
         case Stop:
+            stopPhysics();
             started = false;
             break;
         case SetOutputWindow:
             Render::getInstance().setOutputWindow((ANativeWindow*)event.param);
             break;
+        case SetRefreshRate: {
+            float* refreshRate = (float*)event.param;
+
+            if (*refreshRate > 0)
+                frameTime = 1.0 / *refreshRate;
+
+            delete refreshRate;
+
+            break;
+        }
         default:
             my_assert(false);
             break;
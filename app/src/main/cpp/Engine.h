@@ -8,6 +8,10 @@
 
 #include "readerwriterqueue.h"
 
+#include "FrameStats.h"
+#include "RenderState.h"
+#include "Replay.h"
+
 #include <string>
 
 using namespace moodycamel;
@@ -31,7 +35,8 @@ private:
         Finalize,
         Start,
         Stop,
-        SetOutputWindow
+        SetOutputWindow,
+        SetRefreshRate
     };
 
     struct EngineEvent {
@@ -47,14 +52,30 @@ private:
     BlockingReaderWriterQueue<EngineEvent> eventQueue;
     pthread_t thread;
 
-    const double FPS = 60.0;
-    const double FRAME_TIME = 1.0 / FPS;
     const int MAX_LAG_IN_FRAMES = 0;
 
     bool started, finalized;
+    // one frame per display refresh
+    double frameTime;
     double nextTickTime;
 
-    void setNextTickTime();
+    // between the two states of the newest physics snapshot
+    RenderState drawnState;
+
+    // pacing of the frames and the physics steps, dumped on finalize
+    FrameStats frameStats;
+    const string FRAME_STATS_FILE_NAME = "frame_stats.json";
+
+    // every run of the physics thread, saved when it stops, so issues seen on a device can be replayed on a desktop
+    ReplayRecorder recorder;
+    const string REPLAY_FILE_NAME = "replay.bin";
+
+    // returns the frames skipped because this one ran too late
+    unsigned int setNextTickTime();
+    void saveFrameStats();
+
+    void stopPhysics();
+    void saveReplay();
 
     static void* thread_entrypoint(void* opaque);
     void threadLoop();
@@ -74,6 +95,11 @@ public:
     void stop();
 
     void setOutputWindow(ANativeWindow* window);
+    // frames are drawn at the display rate, the physics thread steps at its own fixed rate
+    void setRefreshRate(float refreshRate);
+
+    // percentiles over the last FrameStats::WINDOW frames and steps, callable from any thread
+    FrameStatsSummary getFrameStats();
 };
 
 #endif //PHYSICSTESTENGINE_H
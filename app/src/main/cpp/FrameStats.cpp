@@ -0,0 +1,149 @@
+#include "FrameStats.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+
+#include "assertUtils.h"
+
+const unsigned int FrameStats::WINDOW;
+
+RollingStats::RollingStats(unsigned int window) : samples(window), next(0), count(0) {
+
+}
+
+void RollingStats::add(double value) {
+
+    samples[next] = value;
+    next = (next + 1) % samples.size();
+    count = std::min(count + 1, (unsigned int) samples.size());
+}
+
+void RollingStats::clear() {
+    next = 0;
+    count = 0;
+}
+
+StatsSummary RollingStats::getSummary() const {
+
+    StatsSummary summary = { count, 0, 0, 0, 0, 0 };
+    if (count == 0)
+        return summary;
+
+    // the oldest samples are overwritten first, so the first count of them are the window either way
+    vector<double> sorted(samples.begin(), samples.begin() + count);
+    sort(sorted.begin(), sorted.end());
+
+    double sum = 0;
+    for (double value : sorted)
+        sum += value;
+
+    // nearest rank
+    auto percentile = [&](double share) {
+        unsigned int rank = (unsigned int)(share * (count - 1) + 0.5);
+        return sorted[rank];
+    };
+
+    summary.mean = sum / count;
+    summary.p50 = percentile(0.5);
+    summary.p95 = percentile(0.95);
+    summary.p99 = percentile(0.99);
+    summary.max = sorted.back();
+
+    return summary;
+}
+
+FrameStats::FrameStats() : tickLateness(WINDOW), physicsTime(WINDOW), renderTime(WINDOW), droppedFrames(WINDOW),
+                           totalFrames(0), totalDroppedFrames(0), totalPhysicsSteps(0) {
+    pthread_check_error(pthread_mutex_init(&mutex, nullptr));
+}
+
+FrameStats::~FrameStats() {
+    pthread_check_error(pthread_mutex_destroy(&mutex));
+}
+
+void FrameStats::addFrame(double tickLateness, double renderTime, unsigned int droppedFrames) {
+
+    pthread_check_error(pthread_mutex_lock(&mutex));
+
+    this->tickLateness.add(tickLateness);
+    this->renderTime.add(renderTime);
+    this->droppedFrames.add(droppedFrames);
+
+    this->totalFrames++;
+    this->totalDroppedFrames += droppedFrames;
+
+    pthread_check_error(pthread_mutex_unlock(&mutex));
+}
+
+void FrameStats::addPhysicsStep(double time) {
+
+    pthread_check_error(pthread_mutex_lock(&mutex));
+
+    this->physicsTime.add(time);
+    this->totalPhysicsSteps++;
+
+    pthread_check_error(pthread_mutex_unlock(&mutex));
+}
+
+void FrameStats::clear() {
+
+    pthread_check_error(pthread_mutex_lock(&mutex));
+
+    this->tickLateness.clear();
+    this->physicsTime.clear();
+    this->renderTime.clear();
+    this->droppedFrames.clear();
+
+    this->totalFrames = 0;
+    this->totalDroppedFrames = 0;
+    this->totalPhysicsSteps = 0;
+
+    pthread_check_error(pthread_mutex_unlock(&mutex));
+}
+
+FrameStatsSummary FrameStats::getSummary() {
+
+    pthread_check_error(pthread_mutex_lock(&mutex));
+
+    FrameStatsSummary summary = {
+        tickLateness.getSummary(),
+        physicsTime.getSummary(),
+        renderTime.getSummary(),
+        droppedFrames.getSummary(),
+        totalFrames,
+        totalDroppedFrames,
+        totalPhysicsSteps
+    };
+
+    pthread_check_error(pthread_mutex_unlock(&mutex));
+
+    return summary;
+}
+
+static string statsToJson(const char* name, const StatsSummary& stats, double scale) {
+
+    char json[256];
+    snprintf(json, sizeof(json),
+             "  \"%s\": {\"count\": %u, \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f}",
+             name, stats.count, stats.mean * scale, stats.p50 * scale, stats.p95 * scale, stats.p99 * scale,
+             stats.max * scale);
+
+    return json;
+}
+
+string FrameStats::toJson(const FrameStatsSummary& summary) {
+
+    char totals[256];
+    snprintf(totals, sizeof(totals),
+             "  \"total_frames\": %llu,\n  \"total_dropped_frames\": %llu,\n  \"total_physics_steps\": %llu\n",
+             summary.totalFrames, summary.totalDroppedFrames, summary.totalPhysicsSteps);
+
+    // times in milliseconds
+    return "{\n" +
+           statsToJson("tick_lateness_ms", summary.tickLateness, 1e3) + ",\n" +
+           statsToJson("physics_time_ms", summary.physicsTime, 1e3) + ",\n" +
+           statsToJson("render_time_ms", summary.renderTime, 1e3) + ",\n" +
+           statsToJson("dropped_frames", summary.droppedFrames, 1.0) + ",\n" +
+           totals + "}\n";
+}
@@ -0,0 +1,72 @@
+#ifndef PHYSICSTEST_FRAME_STATS_H
+#define PHYSICSTEST_FRAME_STATS_H
+
+#include <pthread.h>
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct StatsSummary {
+    unsigned int count;
+    double mean, p50, p95, p99, max;
+};
+
+// the last samples of one quantity, percentiles are only computed when asked for
+class RollingStats {
+private:
+    vector<double> samples;
+    unsigned int next;
+    unsigned int count;
+public:
+    explicit RollingStats(unsigned int window);
+
+    void add(double value);
+    void clear();
+
+    StatsSummary getSummary() const;
+};
+
+struct FrameStatsSummary {
+    // seconds the frames started after they were due
+    StatsSummary tickLateness;
+    // seconds per physics step, from the physics thread
+    StatsSummary physicsTime;
+    // seconds per frame spent drawing, the swap included
+    StatsSummary renderTime;
+    // frames skipped because the previous ones ran late, per frame over the window
+    StatsSummary droppedFrames;
+
+    // since the last clear
+    unsigned long long totalFrames, totalDroppedFrames;
+    unsigned long long totalPhysicsSteps;
+};
+
+// pacing telemetry of the engine, written by the engine and the physics thread and readable from any thread
+class FrameStats {
+public:
+    // samples kept per quantity, about 8 seconds at 120 Hz
+    static const unsigned int WINDOW = 1024;
+private:
+    pthread_mutex_t mutex;
+
+    RollingStats tickLateness, physicsTime, renderTime, droppedFrames;
+    unsigned long long totalFrames, totalDroppedFrames, totalPhysicsSteps;
+public:
+    FrameStats();
+    ~FrameStats();
+
+    FrameStats(FrameStats const&) = delete;
+    void operator=(FrameStats const&) = delete;
+
+    void addFrame(double tickLateness, double renderTime, unsigned int droppedFrames);
+    void addPhysicsStep(double time);
+    void clear();
+
+    FrameStatsSummary getSummary();
+
+    static string toJson(const FrameStatsSummary& summary);
+};
+
+#endif //PHYSICSTEST_FRAME_STATS_H
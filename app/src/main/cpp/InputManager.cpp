@@ -5,7 +5,8 @@
 #include "log.h"
 #include "exceptionUtils.h"
 
-#include "Physics.h"
+#include "PhysicsThread.h"
+#include "Profiler.h"
 #include "Render.h"
 
 #define INPUT_MANAGER_TAG "PT_INPUT_MANAGER"
@@ -56,6 +57,8 @@ void InputManager::finalize() {
 
 void InputManager::applyUserInput() {
 
+    PROFILE_ZONE("InputManager::applyUserInput");
+
     ALooper_pollAll(0, nullptr, nullptr, nullptr);
     ASensorEvent event;
     float a = SENSOR_FILTER_ALPHA;
@@ -82,5 +85,5 @@ void InputManager::applyUserInput() {
 
     // print_log(ANDROID_LOG_INFO, INPUT_MANAGER_TAG, "%f %f %f", rotatedVec.x, rotatedVec.y, rotatedVec.z);
 
-    Physics::getInstance().setGravity(rotatedVec);
+    PhysicsThread::getInstance().setGravity(rotatedVec);
 }
\ No newline at end of file
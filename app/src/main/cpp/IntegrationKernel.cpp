@@ -0,0 +1,187 @@
+#include "IntegrationKernel.h"
+
+#include <math.h>
+
+#if defined(__arm__) && defined(__ANDROID__)
+#include <cpu-features.h>
+#elif defined(__arm__) && defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+void addLinearVelocityScalar(const IntegrationStreams& streams, unsigned int begin, unsigned int end,
+                             float deltaX, float deltaY, float deltaZ) {
+
+    float* vx = streams.linearVelocityX;
+    float* vy = streams.linearVelocityY;
+    float* vz = streams.linearVelocityZ;
+
+    for (unsigned int index = begin; index < end; index++) {
+        vx[index] += deltaX;
+        vy[index] += deltaY;
+        vz[index] += deltaZ;
+    }
+}
+
+void scaleVelocitiesScalar(const IntegrationStreams& streams, unsigned int begin, unsigned int end,
+                           float factor) {
+
+    float* velocities[6] = {
+            streams.linearVelocityX, streams.linearVelocityY, streams.linearVelocityZ,
+            streams.angularVelocityX, streams.angularVelocityY, streams.angularVelocityZ
+    };
+
+    for (unsigned int arrayIndex = 0; arrayIndex < 6; arrayIndex++) {
+        float* v = velocities[arrayIndex];
+        for (unsigned int index = begin; index < end; index++)
+            v[index] *= factor;
+    }
+}
+
+void integrateTransformsScalar(const IntegrationStreams& streams, unsigned int begin, unsigned int end,
+                               float dt) {
+
+    float* px = streams.positionX;
+    float* py = streams.positionY;
+    float* pz = streams.positionZ;
+
+    const float* vx = streams.linearVelocityX;
+    const float* vy = streams.linearVelocityY;
+    const float* vz = streams.linearVelocityZ;
+
+    for (unsigned int index = begin; index < end; index++) {
+        px[index] += vx[index] * dt;
+        py[index] += vy[index] * dt;
+        pz[index] += vz[index] * dt;
+    }
+
+    float* qx = streams.orientationX;
+    float* qy = streams.orientationY;
+    float* qz = streams.orientationZ;
+    float* qw = streams.orientationW;
+
+    const float* wx = streams.angularVelocityX;
+    const float* wy = streams.angularVelocityY;
+    const float* wz = streams.angularVelocityZ;
+
+    float halfDt = dt * 0.5f;
+
+    for (unsigned int index = begin; index < end; index++) {
+
+        // q += 0.5 * (0, w * dt) * q
+        float ax = wx[index] * halfDt, ay = wy[index] * halfDt, az = wz[index] * halfDt;
+        float x = qx[index], y = qy[index], z = qz[index], w = qw[index];
+
+        float dx = w * ax + ay * z - az * y;
+        float dy = w * ay + az * x - ax * z;
+        float dz = w * az + ax * y - ay * x;
+        float dw = -(ax * x + ay * y + az * z);
+
+        x += dx;
+        y += dy;
+        z += dz;
+        w += dw;
+
+        float invLength = 1.0f / sqrtf(x * x + y * y + z * z + w * w);
+
+        qx[index] = x * invLength;
+        qy[index] = y * invLength;
+        qz[index] = z * invLength;
+        qw[index] = w * invLength;
+    }
+}
+
+static void addLinearVelocity(const IntegrationStreams& streams, float deltaX, float deltaY, float deltaZ) {
+    addLinearVelocityScalar(streams, 0, streams.count, deltaX, deltaY, deltaZ);
+}
+
+static void scaleVelocities(const IntegrationStreams& streams, float factor) {
+    scaleVelocitiesScalar(streams, 0, streams.count, factor);
+}
+
+static void integrateTransforms(const IntegrationStreams& streams, float dt) {
+    integrateTransformsScalar(streams, 0, streams.count, dt);
+}
+
+static const IntegrationKernel SCALAR_KERNEL = {
+        "scalar", 1, true, addLinearVelocity, scaleVelocities, integrateTransforms
+};
+
+static bool isSupported(const IntegrationKernel* kernel) {
+
+    if (kernel == nullptr)
+        return false;
+
+    if (kernel == getAVX2IntegrationKernel()) {
+#if defined(__i386__) || defined(__x86_64__)
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+        return false;
+#endif
+    }
+
+    if (kernel == getSSEIntegrationKernel()) {
+#if defined(__i386__) || defined(__x86_64__)
+        return __builtin_cpu_supports("sse2");
+#else
+        return false;
+#endif
+    }
+
+    if (kernel == getNEONIntegrationKernel()) {
+#if defined(__aarch64__)
+        return true;
+#elif defined(__arm__) && defined(__ANDROID__)
+        return (android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON) != 0;
+#elif defined(__arm__) && defined(__linux__)
+        return (getauxval(AT_HWCAP) & HWCAP_NEON) != 0;
+#else
+        return false;
+#endif
+    }
+
+    return false;
+}
+
+unsigned int getAvailableIntegrationKernels(const IntegrationKernel** kernels, unsigned int maxCount) {
+
+    const IntegrationKernel* candidates[] = {
+            &SCALAR_KERNEL,
+            getSSEIntegrationKernel(),
+            getAVX2IntegrationKernel(),
+            getNEONIntegrationKernel()
+    };
+
+    unsigned int count = 0;
+    for (const IntegrationKernel* candidate : candidates)
+        if (count < maxCount && (candidate == &SCALAR_KERNEL || isSupported(candidate)))
+            kernels[count++] = candidate;
+
+    return count;
+}
+
+static const IntegrationKernel* selectIntegrationKernel() {
+
+    const IntegrationKernel* kernels[4];
+    unsigned int count = getAvailableIntegrationKernels(kernels, 4);
+
+    // the widest one wins, among the exact ones if every platform has to get the same results
+    const IntegrationKernel* best = kernels[0];
+    for (unsigned int index = 1; index < count; index++) {
+#ifdef PHYSICSTEST_DETERMINISTIC
+        if (!kernels[index]->exact)
+            continue;
+#endif
+        if (kernels[index]->width > best->width)
+            best = kernels[index];
+    }
+
+    return best;
+}
+
+const IntegrationKernel& getIntegrationKernel() {
+
+    static const IntegrationKernel* kernel = selectIntegrationKernel();
+
+    return *kernel;
+}
@@ -0,0 +1,61 @@
+#ifndef PHYSICSTEST_INTEGRATION_KERNEL_H
+#define PHYSICSTEST_INTEGRATION_KERNEL_H
+
+// raw views of the body arrays the integration passes read and write
+struct IntegrationStreams {
+    float *positionX, *positionY, *positionZ;
+    float *orientationX, *orientationY, *orientationZ, *orientationW;
+    float *linearVelocityX, *linearVelocityY, *linearVelocityZ;
+    float *angularVelocityX, *angularVelocityY, *angularVelocityZ;
+    unsigned int count;
+};
+
+// batched velocity and transform integration, one implementation per instruction set
+//
+// all kernels do exactly the same operations in the same order as the scalar one, per body:
+//   velocity += gravity * dt
+//   velocity *= damping
+//   position += velocity * dt
+//   orientation += 0.5 * (0, angularVelocity * dt) * orientation, then renormalized
+//
+// tolerance against the scalar kernel:
+//   SSE2 uses the same IEEE operations in the same order, but only matches bit for bit when built with
+//   PHYSICS_DETERMINISTIC; under the default -Ofast the compiler turns the scalar 1 / sqrtf into its own
+//   reciprocal square root estimate and reorders freely, so it drifts like the others (1.2e-7 after 1 step,
+//   2.1e-6 after 1000 in KernelBench)
+//   AVX2 fuses multiply-adds, NEON on 32-bit ARM normalizes with a reciprocal square root estimate
+//   refined by two Newton steps; both stay within 4 ulp of the scalar result per step,
+//   which is 5e-7 on unit quaternion components, and keep quaternions unit length within 1e-6
+//   (KernelBench reports the measured deviation after 1 and 1000 steps)
+struct IntegrationKernel {
+    const char* name;
+    // bodies processed per instruction
+    unsigned int width;
+    // matches the scalar kernel bit for bit with PHYSICS_DETERMINISTIC, only these are picked by that build
+    bool exact;
+
+    void (*addLinearVelocity)(const IntegrationStreams& streams, float deltaX, float deltaY, float deltaZ);
+    void (*scaleVelocities)(const IntegrationStreams& streams, float factor);
+    void (*integrateTransforms)(const IntegrationStreams& streams, float dt);
+};
+
+// best kernel the CPU supports, chosen once on first use, the widest exact one in a deterministic build
+const IntegrationKernel& getIntegrationKernel();
+
+// every kernel the build and the CPU support, scalar first
+unsigned int getAvailableIntegrationKernels(const IntegrationKernel** kernels, unsigned int maxCount);
+
+// scalar implementation over [begin, end), the SIMD kernels use it for the remainder
+void addLinearVelocityScalar(const IntegrationStreams& streams, unsigned int begin, unsigned int end,
+                             float deltaX, float deltaY, float deltaZ);
+void scaleVelocitiesScalar(const IntegrationStreams& streams, unsigned int begin, unsigned int end,
+                           float factor);
+void integrateTransformsScalar(const IntegrationStreams& streams, unsigned int begin, unsigned int end,
+                               float dt);
+
+// defined by the instruction set specific translation units, null when not compiled in
+const IntegrationKernel* getSSEIntegrationKernel();
+const IntegrationKernel* getAVX2IntegrationKernel();
+const IntegrationKernel* getNEONIntegrationKernel();
+
+#endif //PHYSICSTEST_INTEGRATION_KERNEL_H
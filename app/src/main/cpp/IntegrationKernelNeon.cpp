@@ -0,0 +1,125 @@
+#include "IntegrationKernel.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+#include <arm_neon.h>
+
+// NEON, 4 bodies per instruction
+
+static void addLinearVelocityNEON(const IntegrationStreams& streams, float deltaX, float deltaY, float deltaZ) {
+
+    unsigned int count = streams.count & ~3u;
+
+    float32x4_t dx = vdupq_n_f32(deltaX), dy = vdupq_n_f32(deltaY), dz = vdupq_n_f32(deltaZ);
+
+    for (unsigned int index = 0; index < count; index += 4) {
+        vst1q_f32(streams.linearVelocityX + index, vaddq_f32(vld1q_f32(streams.linearVelocityX + index), dx));
+        vst1q_f32(streams.linearVelocityY + index, vaddq_f32(vld1q_f32(streams.linearVelocityY + index), dy));
+        vst1q_f32(streams.linearVelocityZ + index, vaddq_f32(vld1q_f32(streams.linearVelocityZ + index), dz));
+    }
+
+    addLinearVelocityScalar(streams, count, streams.count, deltaX, deltaY, deltaZ);
+}
+
+static void scaleVelocitiesNEON(const IntegrationStreams& streams, float factor) {
+
+    unsigned int count = streams.count & ~3u;
+
+    float* velocities[6] = {
+            streams.linearVelocityX, streams.linearVelocityY, streams.linearVelocityZ,
+            streams.angularVelocityX, streams.angularVelocityY, streams.angularVelocityZ
+    };
+
+    float32x4_t m = vdupq_n_f32(factor);
+
+    for (unsigned int arrayIndex = 0; arrayIndex < 6; arrayIndex++) {
+        float* v = velocities[arrayIndex];
+        for (unsigned int index = 0; index < count; index += 4)
+            vst1q_f32(v + index, vmulq_f32(vld1q_f32(v + index), m));
+    }
+
+    scaleVelocitiesScalar(streams, count, streams.count, factor);
+}
+
+static inline float32x4_t reciprocalLength(float32x4_t lengthSq) {
+#if defined(__aarch64__)
+    return vdivq_f32(vdupq_n_f32(1.0f), vsqrtq_f32(lengthSq));
+#else
+    // no vector sqrt/divide on 32-bit ARM, estimate + two Newton steps
+    float32x4_t estimate = vrsqrteq_f32(lengthSq);
+    estimate = vmulq_f32(estimate, vrsqrtsq_f32(vmulq_f32(lengthSq, estimate), estimate));
+    estimate = vmulq_f32(estimate, vrsqrtsq_f32(vmulq_f32(lengthSq, estimate), estimate));
+    return estimate;
+#endif
+}
+
+static void integrateTransformsNEON(const IntegrationStreams& streams, float dt) {
+
+    unsigned int count = streams.count & ~3u;
+
+    float32x4_t vdt = vdupq_n_f32(dt);
+    float32x4_t halfDt = vdupq_n_f32(dt * 0.5f);
+
+    for (unsigned int index = 0; index < count; index += 4) {
+
+        vst1q_f32(streams.positionX + index, vaddq_f32(vld1q_f32(streams.positionX + index),
+                vmulq_f32(vld1q_f32(streams.linearVelocityX + index), vdt)));
+        vst1q_f32(streams.positionY + index, vaddq_f32(vld1q_f32(streams.positionY + index),
+                vmulq_f32(vld1q_f32(streams.linearVelocityY + index), vdt)));
+        vst1q_f32(streams.positionZ + index, vaddq_f32(vld1q_f32(streams.positionZ + index),
+                vmulq_f32(vld1q_f32(streams.linearVelocityZ + index), vdt)));
+
+        float32x4_t ax = vmulq_f32(vld1q_f32(streams.angularVelocityX + index), halfDt);
+        float32x4_t ay = vmulq_f32(vld1q_f32(streams.angularVelocityY + index), halfDt);
+        float32x4_t az = vmulq_f32(vld1q_f32(streams.angularVelocityZ + index), halfDt);
+
+        float32x4_t x = vld1q_f32(streams.orientationX + index);
+        float32x4_t y = vld1q_f32(streams.orientationY + index);
+        float32x4_t z = vld1q_f32(streams.orientationZ + index);
+        float32x4_t w = vld1q_f32(streams.orientationW + index);
+
+        float32x4_t dx = vsubq_f32(vaddq_f32(vmulq_f32(w, ax), vmulq_f32(ay, z)), vmulq_f32(az, y));
+        float32x4_t dy = vsubq_f32(vaddq_f32(vmulq_f32(w, ay), vmulq_f32(az, x)), vmulq_f32(ax, z));
+        float32x4_t dz = vsubq_f32(vaddq_f32(vmulq_f32(w, az), vmulq_f32(ax, y)), vmulq_f32(ay, x));
+        float32x4_t dw = vaddq_f32(vaddq_f32(vmulq_f32(ax, x), vmulq_f32(ay, y)), vmulq_f32(az, z));
+
+        x = vaddq_f32(x, dx);
+        y = vaddq_f32(y, dy);
+        z = vaddq_f32(z, dz);
+        w = vsubq_f32(w, dw);
+
+        float32x4_t lengthSq = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(x, x), vmulq_f32(y, y)),
+                vmulq_f32(z, z)), vmulq_f32(w, w));
+        float32x4_t invLength = reciprocalLength(lengthSq);
+
+        vst1q_f32(streams.orientationX + index, vmulq_f32(x, invLength));
+        vst1q_f32(streams.orientationY + index, vmulq_f32(y, invLength));
+        vst1q_f32(streams.orientationZ + index, vmulq_f32(z, invLength));
+        vst1q_f32(streams.orientationW + index, vmulq_f32(w, invLength));
+    }
+
+    integrateTransformsScalar(streams, count, streams.count, dt);
+}
+
+// the reciprocal square root estimate of 32-bit ARM rounds differently from the scalar division
+#if defined(__aarch64__)
+static const bool NEON_EXACT = true;
+#else
+static const bool NEON_EXACT = false;
+#endif
+
+static const IntegrationKernel NEON_KERNEL = {
+        "neon", 4, NEON_EXACT, addLinearVelocityNEON, scaleVelocitiesNEON, integrateTransformsNEON
+};
+
+const IntegrationKernel* getNEONIntegrationKernel() {
+    return &NEON_KERNEL;
+}
+
+#else
+
+const IntegrationKernel* getNEONIntegrationKernel() {
+    return nullptr;
+}
+
+#endif
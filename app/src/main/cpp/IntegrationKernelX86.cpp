@@ -0,0 +1,217 @@
+#include "IntegrationKernel.h"
+
+#if defined(__i386__) || defined(__x86_64__)
+
+#include <immintrin.h>
+
+// SSE2, 4 bodies per instruction
+
+__attribute__((target("sse2")))
+static void addLinearVelocitySSE(const IntegrationStreams& streams, float deltaX, float deltaY, float deltaZ) {
+
+    unsigned int count = streams.count & ~3u;
+
+    __m128 dx = _mm_set1_ps(deltaX), dy = _mm_set1_ps(deltaY), dz = _mm_set1_ps(deltaZ);
+
+    for (unsigned int index = 0; index < count; index += 4) {
+        _mm_store_ps(streams.linearVelocityX + index, _mm_add_ps(_mm_load_ps(streams.linearVelocityX + index), dx));
+        _mm_store_ps(streams.linearVelocityY + index, _mm_add_ps(_mm_load_ps(streams.linearVelocityY + index), dy));
+        _mm_store_ps(streams.linearVelocityZ + index, _mm_add_ps(_mm_load_ps(streams.linearVelocityZ + index), dz));
+    }
+
+    addLinearVelocityScalar(streams, count, streams.count, deltaX, deltaY, deltaZ);
+}
+
+__attribute__((target("sse2")))
+static void scaleVelocitiesSSE(const IntegrationStreams& streams, float factor) {
+
+    unsigned int count = streams.count & ~3u;
+
+    float* velocities[6] = {
+            streams.linearVelocityX, streams.linearVelocityY, streams.linearVelocityZ,
+            streams.angularVelocityX, streams.angularVelocityY, streams.angularVelocityZ
+    };
+
+    __m128 m = _mm_set1_ps(factor);
+
+    for (unsigned int arrayIndex = 0; arrayIndex < 6; arrayIndex++) {
+        float* v = velocities[arrayIndex];
+        for (unsigned int index = 0; index < count; index += 4)
+            _mm_store_ps(v + index, _mm_mul_ps(_mm_load_ps(v + index), m));
+    }
+
+    scaleVelocitiesScalar(streams, count, streams.count, factor);
+}
+
+__attribute__((target("sse2")))
+static void integrateTransformsSSE(const IntegrationStreams& streams, float dt) {
+
+    unsigned int count = streams.count & ~3u;
+
+    __m128 vdt = _mm_set1_ps(dt);
+    __m128 halfDt = _mm_set1_ps(dt * 0.5f);
+    __m128 one = _mm_set1_ps(1.0f);
+
+    for (unsigned int index = 0; index < count; index += 4) {
+
+        _mm_store_ps(streams.positionX + index, _mm_add_ps(_mm_load_ps(streams.positionX + index),
+                _mm_mul_ps(_mm_load_ps(streams.linearVelocityX + index), vdt)));
+        _mm_store_ps(streams.positionY + index, _mm_add_ps(_mm_load_ps(streams.positionY + index),
+                _mm_mul_ps(_mm_load_ps(streams.linearVelocityY + index), vdt)));
+        _mm_store_ps(streams.positionZ + index, _mm_add_ps(_mm_load_ps(streams.positionZ + index),
+                _mm_mul_ps(_mm_load_ps(streams.linearVelocityZ + index), vdt)));
+
+        __m128 ax = _mm_mul_ps(_mm_load_ps(streams.angularVelocityX + index), halfDt);
+        __m128 ay = _mm_mul_ps(_mm_load_ps(streams.angularVelocityY + index), halfDt);
+        __m128 az = _mm_mul_ps(_mm_load_ps(streams.angularVelocityZ + index), halfDt);
+
+        __m128 x = _mm_load_ps(streams.orientationX + index);
+        __m128 y = _mm_load_ps(streams.orientationY + index);
+        __m128 z = _mm_load_ps(streams.orientationZ + index);
+        __m128 w = _mm_load_ps(streams.orientationW + index);
+
+        __m128 dx = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(w, ax), _mm_mul_ps(ay, z)), _mm_mul_ps(az, y));
+        __m128 dy = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(w, ay), _mm_mul_ps(az, x)), _mm_mul_ps(ax, z));
+        __m128 dz = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(w, az), _mm_mul_ps(ax, y)), _mm_mul_ps(ay, x));
+        __m128 dw = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, x), _mm_mul_ps(ay, y)), _mm_mul_ps(az, z));
+
+        x = _mm_add_ps(x, dx);
+        y = _mm_add_ps(y, dy);
+        z = _mm_add_ps(z, dz);
+        w = _mm_sub_ps(w, dw);
+
+        __m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+                _mm_mul_ps(z, z)), _mm_mul_ps(w, w));
+        __m128 invLength = _mm_div_ps(one, _mm_sqrt_ps(lengthSq));
+
+        _mm_store_ps(streams.orientationX + index, _mm_mul_ps(x, invLength));
+        _mm_store_ps(streams.orientationY + index, _mm_mul_ps(y, invLength));
+        _mm_store_ps(streams.orientationZ + index, _mm_mul_ps(z, invLength));
+        _mm_store_ps(streams.orientationW + index, _mm_mul_ps(w, invLength));
+    }
+
+    integrateTransformsScalar(streams, count, streams.count, dt);
+}
+
+static const IntegrationKernel SSE_KERNEL = {
+        "sse2", 4, true, addLinearVelocitySSE, scaleVelocitiesSSE, integrateTransformsSSE
+};
+
+// AVX2 + FMA, 8 bodies per instruction
+
+__attribute__((target("avx2,fma")))
+static void addLinearVelocityAVX2(const IntegrationStreams& streams, float deltaX, float deltaY, float deltaZ) {
+
+    unsigned int count = streams.count & ~7u;
+
+    __m256 dx = _mm256_set1_ps(deltaX), dy = _mm256_set1_ps(deltaY), dz = _mm256_set1_ps(deltaZ);
+
+    for (unsigned int index = 0; index < count; index += 8) {
+        _mm256_store_ps(streams.linearVelocityX + index,
+                _mm256_add_ps(_mm256_load_ps(streams.linearVelocityX + index), dx));
+        _mm256_store_ps(streams.linearVelocityY + index,
+                _mm256_add_ps(_mm256_load_ps(streams.linearVelocityY + index), dy));
+        _mm256_store_ps(streams.linearVelocityZ + index,
+                _mm256_add_ps(_mm256_load_ps(streams.linearVelocityZ + index), dz));
+    }
+
+    addLinearVelocityScalar(streams, count, streams.count, deltaX, deltaY, deltaZ);
+}
+
+__attribute__((target("avx2,fma")))
+static void scaleVelocitiesAVX2(const IntegrationStreams& streams, float factor) {
+
+    unsigned int count = streams.count & ~7u;
+
+    float* velocities[6] = {
+            streams.linearVelocityX, streams.linearVelocityY, streams.linearVelocityZ,
+            streams.angularVelocityX, streams.angularVelocityY, streams.angularVelocityZ
+    };
+
+    __m256 m = _mm256_set1_ps(factor);
+
+    for (unsigned int arrayIndex = 0; arrayIndex < 6; arrayIndex++) {
+        float* v = velocities[arrayIndex];
+        for (unsigned int index = 0; index < count; index += 8)
+            _mm256_store_ps(v + index, _mm256_mul_ps(_mm256_load_ps(v + index), m));
+    }
+
+    scaleVelocitiesScalar(streams, count, streams.count, factor);
+}
+
+__attribute__((target("avx2,fma")))
+static void integrateTransformsAVX2(const IntegrationStreams& streams, float dt) {
+
+    unsigned int count = streams.count & ~7u;
+
+    __m256 vdt = _mm256_set1_ps(dt);
+    __m256 halfDt = _mm256_set1_ps(dt * 0.5f);
+    __m256 one = _mm256_set1_ps(1.0f);
+
+    for (unsigned int index = 0; index < count; index += 8) {
+
+        _mm256_store_ps(streams.positionX + index, _mm256_fmadd_ps(_mm256_load_ps(streams.linearVelocityX + index),
+                vdt, _mm256_load_ps(streams.positionX + index)));
+        _mm256_store_ps(streams.positionY + index, _mm256_fmadd_ps(_mm256_load_ps(streams.linearVelocityY + index),
+                vdt, _mm256_load_ps(streams.positionY + index)));
+        _mm256_store_ps(streams.positionZ + index, _mm256_fmadd_ps(_mm256_load_ps(streams.linearVelocityZ + index),
+                vdt, _mm256_load_ps(streams.positionZ + index)));
+
+        __m256 ax = _mm256_mul_ps(_mm256_load_ps(streams.angularVelocityX + index), halfDt);
+        __m256 ay = _mm256_mul_ps(_mm256_load_ps(streams.angularVelocityY + index), halfDt);
+        __m256 az = _mm256_mul_ps(_mm256_load_ps(streams.angularVelocityZ + index), halfDt);
+
+        __m256 x = _mm256_load_ps(streams.orientationX + index);
+        __m256 y = _mm256_load_ps(streams.orientationY + index);
+        __m256 z = _mm256_load_ps(streams.orientationZ + index);
+        __m256 w = _mm256_load_ps(streams.orientationW + index);
+
+        __m256 dx = _mm256_fmsub_ps(ay, z, _mm256_mul_ps(az, y));
+        __m256 dy = _mm256_fmsub_ps(az, x, _mm256_mul_ps(ax, z));
+        __m256 dz = _mm256_fmsub_ps(ax, y, _mm256_mul_ps(ay, x));
+        __m256 dw = _mm256_fmadd_ps(az, z, _mm256_fmadd_ps(ay, y, _mm256_mul_ps(ax, x)));
+
+        dx = _mm256_fmadd_ps(w, ax, dx);
+        dy = _mm256_fmadd_ps(w, ay, dy);
+        dz = _mm256_fmadd_ps(w, az, dz);
+
+        x = _mm256_add_ps(x, dx);
+        y = _mm256_add_ps(y, dy);
+        z = _mm256_add_ps(z, dz);
+        w = _mm256_sub_ps(w, dw);
+
+        __m256 lengthSq = _mm256_fmadd_ps(w, w, _mm256_fmadd_ps(z, z, _mm256_fmadd_ps(y, y, _mm256_mul_ps(x, x))));
+        __m256 invLength = _mm256_div_ps(one, _mm256_sqrt_ps(lengthSq));
+
+        _mm256_store_ps(streams.orientationX + index, _mm256_mul_ps(x, invLength));
+        _mm256_store_ps(streams.orientationY + index, _mm256_mul_ps(y, invLength));
+        _mm256_store_ps(streams.orientationZ + index, _mm256_mul_ps(z, invLength));
+        _mm256_store_ps(streams.orientationW + index, _mm256_mul_ps(w, invLength));
+    }
+
+    integrateTransformsScalar(streams, count, streams.count, dt);
+}
+
+static const IntegrationKernel AVX2_KERNEL = {
+        "avx2", 8, false, addLinearVelocityAVX2, scaleVelocitiesAVX2, integrateTransformsAVX2
+};
+
+const IntegrationKernel* getSSEIntegrationKernel() {
+    return &SSE_KERNEL;
+}
+
+const IntegrationKernel* getAVX2IntegrationKernel() {
+    return &AVX2_KERNEL;
+}
+
+#else
+
+const IntegrationKernel* getSSEIntegrationKernel() {
+    return nullptr;
+}
+
+const IntegrationKernel* getAVX2IntegrationKernel() {
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,155 @@
+#include "Islands.h"
+
+#include <algorithm>
+
+const unsigned int Islands::NO_ISLAND;
+constexpr float Islands::LINEAR_SLEEP_VELOCITY;
+constexpr float Islands::ANGULAR_SLEEP_VELOCITY;
+constexpr float Islands::TIME_TO_SLEEP;
+
+unsigned int Islands::find(unsigned int index) {
+
+    // path halving
+    while (parent[index] != index) {
+        parent[index] = parent[parent[index]];
+        index = parent[index];
+    }
+
+    return index;
+}
+
+void Islands::unite(unsigned int a, unsigned int b) {
+
+    a = find(a);
+    b = find(b);
+
+    if (a != b)
+        parent[std::max(a, b)] = std::min(a, b);
+}
+
+void Islands::build(const vector<ContactManifold>& manifolds, BodyStorage& bodies) {
+
+    unsigned int bodyCount = bodies.size();
+
+    parent.resize(bodyCount);
+    for (unsigned int index = 0; index < bodyCount; index++)
+        parent[index] = index;
+
+    for (const ContactManifold& manifold : manifolds)
+        if (!ContactManifold::isWall(manifold.b))
+            unite(manifold.a, manifold.b);
+
+    // number the islands and count their bodies, rootIsland ends up holding the island of every body
+    rootIsland.assign(bodyCount, NO_ISLAND);
+    islands.clear();
+
+    for (unsigned int index = 0; index < bodyCount; index++) {
+
+        unsigned int root = find(index);
+        if (rootIsland[root] == NO_ISLAND) {
+            rootIsland[root] = (unsigned int)islands.size();
+            islands.push_back({ 0, 0, false });
+        }
+
+        Island& island = islands[rootIsland[root]];
+        island.bodyCount++;
+        island.awake = island.awake || bodies.isAwake(index);
+
+        // roots never come after their members, so the root is already numbered
+        rootIsland[index] = rootIsland[root];
+    }
+
+    unsigned int offset = 0;
+    for (Island& island : islands) {
+        island.bodyBegin = offset;
+        offset += island.bodyCount;
+        island.bodyCount = 0;
+    }
+
+    islandBodies.resize(bodyCount);
+    for (unsigned int index = 0; index < bodyCount; index++) {
+        Island& island = islands[rootIsland[index]];
+        islandBodies[island.bodyBegin + island.bodyCount++] = index;
+    }
+
+    for (const Island& island : islands) {
+        if (!island.awake)
+            continue;
+
+        for (unsigned int index = 0; index < island.bodyCount; index++)
+            bodies.setAwake(islandBodies[island.bodyBegin + index], true);
+    }
+
+    // counting sort of the manifolds by island, sleeping islands left out
+    manifoldOffsets.assign(islands.size() + 1, 0);
+
+    for (const ContactManifold& manifold : manifolds) {
+        unsigned int island = rootIsland[manifold.a];
+        if (islands[island].awake)
+            manifoldOffsets[island + 1]++;
+    }
+
+    for (unsigned int island = 0; island < islands.size(); island++)
+        manifoldOffsets[island + 1] += manifoldOffsets[island];
+
+    awakeGroupOffsets.clear();
+    awakeGroupOffsets.push_back(0);
+    for (unsigned int island = 0; island < islands.size(); island++)
+        if (manifoldOffsets[island + 1] > manifoldOffsets[island])
+            awakeGroupOffsets.push_back(manifoldOffsets[island + 1]);
+
+    awakeManifolds.resize(manifoldOffsets.back());
+
+    for (unsigned int index = 0; index < manifolds.size(); index++) {
+        unsigned int island = rootIsland[manifolds[index].a];
+        if (islands[island].awake)
+            awakeManifolds[manifoldOffsets[island]++] = index;
+    }
+}
+
+void Islands::updateSleeping(BodyStorage& bodies, float dt) {
+
+    const float linearSq = LINEAR_SLEEP_VELOCITY * LINEAR_SLEEP_VELOCITY;
+    const float angularSq = ANGULAR_SLEEP_VELOCITY * ANGULAR_SLEEP_VELOCITY;
+
+    for (const Island& island : islands) {
+
+        if (!island.awake)
+            continue;
+
+        float minSleepTime = TIME_TO_SLEEP;
+
+        for (unsigned int index = 0; index < island.bodyCount; index++) {
+
+            unsigned int body = islandBodies[island.bodyBegin + index];
+
+            vec3 linearVelocity = bodies.getLinearVelocity(body);
+            vec3 angularVelocity = bodies.getAngularVelocity(body);
+
+            float sleepTime = 0;
+            if (dot(linearVelocity, linearVelocity) <= linearSq && dot(angularVelocity, angularVelocity) <= angularSq)
+                sleepTime = bodies.getSleepTime(body) + dt;
+
+            bodies.setSleepTime(body, sleepTime);
+            minSleepTime = std::min(minSleepTime, sleepTime);
+        }
+
+        if (minSleepTime < TIME_TO_SLEEP)
+            continue;
+
+        for (unsigned int index = 0; index < island.bodyCount; index++)
+            bodies.setAwake(islandBodies[island.bodyBegin + index], false);
+    }
+}
+
+const vector<unsigned int>& Islands::getAwakeManifolds() const {
+    return awakeManifolds;
+}
+
+const vector<unsigned int>& Islands::getAwakeGroupOffsets() const {
+    return awakeGroupOffsets;
+}
+
+unsigned int Islands::getIslandCount() const {
+    return (unsigned int)islands.size();
+}
@@ -0,0 +1,54 @@
+#ifndef PHYSICSTEST_ISLANDS_H
+#define PHYSICSTEST_ISLANDS_H
+
+#include <vector>
+
+#include "BodyStorage.h"
+#include "Narrowphase.h"
+
+using namespace std;
+
+// groups of bodies connected through contacts, built with union-find every substep
+// walls do not connect anything, so bodies that only share a wall stay in separate islands
+// an island is awake as a whole: one awake body wakes everything it touches,
+// and it only goes to sleep once every body in it has been slow for a while
+class Islands {
+private:
+    static const unsigned int NO_ISLAND = 0xFFFFFFFF;
+
+    static constexpr float LINEAR_SLEEP_VELOCITY = 0.05f;
+    static constexpr float ANGULAR_SLEEP_VELOCITY = 0.1f;
+    // seconds every body of an island has to stay under both velocities
+    static constexpr float TIME_TO_SLEEP = 0.5f;
+
+    struct Island {
+        unsigned int bodyBegin, bodyCount;
+        bool awake;
+    };
+
+    vector<unsigned int> parent;
+    vector<unsigned int> rootIsland;
+
+    vector<Island> islands;
+    // body indices grouped by island
+    vector<unsigned int> islandBodies;
+    // manifold indices of the awake islands, grouped by island
+    vector<unsigned int> manifoldOffsets;
+    vector<unsigned int> awakeManifolds;
+    // where each island with contacts starts in awakeManifolds, plus the end
+    vector<unsigned int> awakeGroupOffsets;
+
+    unsigned int find(unsigned int index);
+    void unite(unsigned int a, unsigned int b);
+public:
+    // wakes every island that holds an awake body
+    void build(const vector<ContactManifold>& manifolds, BodyStorage& bodies);
+    // after integration, puts the islands that stayed quiet long enough to sleep
+    void updateSleeping(BodyStorage& bodies, float dt);
+
+    const vector<unsigned int>& getAwakeManifolds() const;
+    const vector<unsigned int>& getAwakeGroupOffsets() const;
+    unsigned int getIslandCount() const;
+};
+
+#endif //PHYSICSTEST_ISLANDS_H
@@ -87,4 +87,17 @@ extern "C" JNIEXPORT void JNICALL Java_com_example_physicstest_JNIHandler_setOut
     } catch(...) {
         swallow_cpp_exception_and_throw_java(env);
     }
-}
\ No newline at end of file
+}
+
+extern "C" JNIEXPORT void JNICALL Java_com_example_physicstest_JNIHandler_setRefreshRate(
+        JNIEnv *env, jclass /*this*/, jfloat refreshRate) {
+    try {
+        COFFEE_TRY() {
+            Engine::getInstance().setRefreshRate(refreshRate);
+        } COFFEE_CATCH() {
+            coffeecatch_throw_exception(env);
+        } COFFEE_END();
+    } catch(...) {
+        swallow_cpp_exception_and_throw_java(env);
+    }
+}
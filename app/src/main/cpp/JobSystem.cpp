@@ -0,0 +1,185 @@
+#include "JobSystem.h"
+
+#include <unistd.h>
+
+#include "assertUtils.h"
+#include "Profiler.h"
+
+JobSystem::JobSystem(unsigned int threadCount) : generation(0), quitting(false), job(nullptr), remaining(0) {
+
+    if (threadCount == 0)
+        threadCount = getCoreCount();
+
+    pthread_check_error(pthread_mutex_init(&mutex, nullptr));
+    pthread_check_error(pthread_cond_init(&wakeCondition, nullptr));
+    pthread_check_error(pthread_cond_init(&doneCondition, nullptr));
+
+    for (unsigned int index = 0; index < threadCount; index++) {
+        Worker* worker = new Worker();
+        pthread_check_error(pthread_mutex_init(&worker->mutex, nullptr));
+        workers.push_back(worker);
+    }
+
+    // params must not move once the threads have them
+    threadParams.resize(threadCount);
+
+    for (unsigned int index = 1; index < threadCount; index++) {
+        threadParams[index] = { this, index };
+        pthread_check_error(pthread_create(&workers[index]->thread, nullptr, thread_entrypoint, &threadParams[index]));
+    }
+}
+
+JobSystem::~JobSystem() {
+
+    pthread_check_error(pthread_mutex_lock(&mutex));
+    quitting = true;
+    pthread_check_error(pthread_cond_broadcast(&wakeCondition));
+    pthread_check_error(pthread_mutex_unlock(&mutex));
+
+    for (unsigned int index = 1; index < workers.size(); index++)
+        pthread_check_error(pthread_join(workers[index]->thread, nullptr));
+
+    for (Worker* worker : workers) {
+        pthread_check_error(pthread_mutex_destroy(&worker->mutex));
+        delete worker;
+    }
+
+    pthread_check_error(pthread_cond_destroy(&doneCondition));
+    pthread_check_error(pthread_cond_destroy(&wakeCondition));
+    pthread_check_error(pthread_mutex_destroy(&mutex));
+}
+
+unsigned int JobSystem::getCoreCount() {
+
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (unsigned int)count : 1;
+}
+
+unsigned int JobSystem::getThreadCount() const {
+    return (unsigned int)workers.size();
+}
+
+bool JobSystem::takeJob(unsigned int workerIndex, unsigned int& jobIndex) {
+
+    unsigned int workerCount = (unsigned int)workers.size();
+
+    for (unsigned int offset = 0; offset < workerCount; offset++) {
+
+        Worker* worker = workers[(workerIndex + offset) % workerCount];
+        bool own = offset == 0;
+
+        pthread_check_error(pthread_mutex_lock(&worker->mutex));
+
+        bool found = !worker->jobs.empty();
+        if (found) {
+            if (own) {
+                jobIndex = worker->jobs.back();
+                worker->jobs.pop_back();
+            } else {
+                jobIndex = worker->jobs.front();
+                worker->jobs.pop_front();
+            }
+        }
+
+        pthread_check_error(pthread_mutex_unlock(&worker->mutex));
+
+        if (found)
+            return true;
+    }
+
+    return false;
+}
+
+void JobSystem::runJobs(unsigned int workerIndex) {
+
+    PROFILE_ZONE("JobSystem::runJobs");
+
+    unsigned int jobIndex;
+    while (takeJob(workerIndex, jobIndex)) {
+
+        // the job was queued under the deque mutex after the function was set, so reading it here is safe
+        (*job)(jobIndex);
+
+        if (remaining.fetch_sub(1) == 1) {
+            pthread_check_error(pthread_mutex_lock(&mutex));
+            pthread_check_error(pthread_cond_signal(&doneCondition));
+            pthread_check_error(pthread_mutex_unlock(&mutex));
+        }
+    }
+}
+
+void JobSystem::parallelFor(unsigned int count, const function<void(unsigned int)>& job) {
+
+    if (count == 0)
+        return;
+
+    unsigned int workerCount = (unsigned int)workers.size();
+
+    if (workerCount == 1 || count == 1) {
+        for (unsigned int index = 0; index < count; index++)
+            job(index);
+        return;
+    }
+
+    this->job = &job;
+    this->remaining = count;
+
+    // contiguous runs, so neighbouring jobs tend to stay on the same thread
+    for (unsigned int workerIndex = 0; workerIndex < workerCount; workerIndex++) {
+
+        Worker* worker = workers[workerIndex];
+        unsigned int begin = (unsigned int)((unsigned long long)count * workerIndex / workerCount);
+        unsigned int end = (unsigned int)((unsigned long long)count * (workerIndex + 1) / workerCount);
+
+        pthread_check_error(pthread_mutex_lock(&worker->mutex));
+        // the owner takes from the back, so queue in reverse to have it start at the beginning
+        for (unsigned int index = end; index > begin; index--)
+            worker->jobs.push_back(index - 1);
+        pthread_check_error(pthread_mutex_unlock(&worker->mutex));
+    }
+
+    pthread_check_error(pthread_mutex_lock(&mutex));
+    generation++;
+    pthread_check_error(pthread_cond_broadcast(&wakeCondition));
+    pthread_check_error(pthread_mutex_unlock(&mutex));
+
+    runJobs(0);
+
+    pthread_check_error(pthread_mutex_lock(&mutex));
+    while (remaining != 0)
+        pthread_check_error(pthread_cond_wait(&doneCondition, &mutex));
+    pthread_check_error(pthread_mutex_unlock(&mutex));
+
+    this->job = nullptr;
+}
+
+// threads
+
+void* JobSystem::thread_entrypoint(void* opaque) {
+
+    ThreadParam* param = (ThreadParam*)opaque;
+    param->system->threadLoop(param->workerIndex);
+    return nullptr;
+}
+
+void JobSystem::threadLoop(unsigned int workerIndex) {
+
+    PROFILE_THREAD_NAME("job " + to_string(workerIndex));
+
+    unsigned int seenGeneration = 0;
+
+    while (true) {
+
+        pthread_check_error(pthread_mutex_lock(&mutex));
+        while (!quitting && generation == seenGeneration)
+            pthread_check_error(pthread_cond_wait(&wakeCondition, &mutex));
+        seenGeneration = generation;
+        bool quit = quitting;
+        pthread_check_error(pthread_mutex_unlock(&mutex));
+
+        if (quit)
+            break;
+
+        runJobs(workerIndex);
+    }
+}
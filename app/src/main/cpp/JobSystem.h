@@ -0,0 +1,62 @@
+#ifndef PHYSICSTEST_JOB_SYSTEM_H
+#define PHYSICSTEST_JOB_SYSTEM_H
+
+#include <pthread.h>
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <vector>
+
+using namespace std;
+
+// fixed pool of threads running indexed jobs, the calling thread takes part as thread 0
+// every thread has its own deque: it takes its newest job from the back,
+// and once it runs dry it steals the oldest job from the front of another thread's deque
+class JobSystem {
+private:
+    struct Worker {
+        pthread_t thread;
+        pthread_mutex_t mutex;
+        deque<unsigned int> jobs;
+    };
+
+    struct ThreadParam {
+        JobSystem* system;
+        unsigned int workerIndex;
+    };
+
+    vector<Worker*> workers;
+    vector<ThreadParam> threadParams;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t wakeCondition, doneCondition;
+    // bumped by every parallelFor, wakes the threads
+    unsigned int generation;
+    bool quitting;
+
+    const function<void(unsigned int)>* job;
+    atomic<unsigned int> remaining;
+
+    bool takeJob(unsigned int workerIndex, unsigned int& jobIndex);
+    void runJobs(unsigned int workerIndex);
+
+    static void* thread_entrypoint(void* opaque);
+    void threadLoop(unsigned int workerIndex);
+public:
+    // 0 means one thread per core
+    explicit JobSystem(unsigned int threadCount = 0);
+    ~JobSystem();
+
+    JobSystem(JobSystem const&) = delete;
+    void operator=(JobSystem const&) = delete;
+
+    static unsigned int getCoreCount();
+    unsigned int getThreadCount() const;
+
+    // runs job(0) .. job(count - 1) and returns once all of them have finished
+    // jobs run in any order on any thread, so they must not share anything they write
+    void parallelFor(unsigned int count, const function<void(unsigned int)>& job);
+};
+
+#endif //PHYSICSTEST_JOB_SYSTEM_H
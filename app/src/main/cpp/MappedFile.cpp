@@ -0,0 +1,82 @@
+#include "MappedFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// an empty file has no mapping but is still open
+static unsigned char EMPTY_FILE[1];
+
+MappedFile::MappedFile() : mapping(nullptr), size(0) {
+
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(string fileName, bool populate) {
+
+    close();
+
+    int fileHandle = ::open(fileName.c_str(), O_RDONLY);
+    if (fileHandle < 0)
+        return false;
+
+    struct stat fileStat;
+    if (fstat(fileHandle, &fileStat) != 0) {
+        ::close(fileHandle);
+        return false;
+    }
+
+    if (fileStat.st_size == 0) {
+        ::close(fileHandle);
+        this->mapping = EMPTY_FILE;
+        this->size = 0;
+        return true;
+    }
+
+    int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    if (populate)
+        flags |= MAP_POPULATE;
+#endif
+
+    void* mapping = mmap(nullptr, (size_t) fileStat.st_size, PROT_READ, flags, fileHandle, 0);
+
+    // the mapping keeps the file alive on its own
+    ::close(fileHandle);
+
+    if (mapping == MAP_FAILED)
+        return false;
+
+    if (!populate)
+        madvise(mapping, (size_t) fileStat.st_size, MADV_SEQUENTIAL);
+
+    this->mapping = mapping;
+    this->size = (size_t) fileStat.st_size;
+
+    return true;
+}
+
+void MappedFile::close() {
+
+    if (this->mapping != nullptr && this->mapping != EMPTY_FILE)
+        munmap(this->mapping, this->size);
+
+    this->mapping = nullptr;
+    this->size = 0;
+}
+
+bool MappedFile::isOpen() const {
+    return this->mapping != nullptr;
+}
+
+const unsigned char* MappedFile::getData() const {
+    return (const unsigned char*) this->mapping;
+}
+
+size_t MappedFile::getSize() const {
+    return this->size;
+}
@@ -0,0 +1,32 @@
+#ifndef PHYSICSTEST_MAPPED_FILE_H
+#define PHYSICSTEST_MAPPED_FILE_H
+
+#include <stddef.h>
+
+#include <string>
+
+using namespace std;
+
+// read only view of a whole file mapped into memory, the data is used in place instead of being read into a buffer
+class MappedFile {
+private:
+    void* mapping;
+    size_t size;
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(MappedFile const&) = delete;
+    void operator=(MappedFile const&) = delete;
+
+    // false if the file is missing or can't be mapped, populate faults every page in up front,
+    // which is cheaper than faulting them one by one when the whole file is read anyway
+    bool open(string fileName, bool populate = true);
+    void close();
+
+    bool isOpen() const;
+    const unsigned char* getData() const;
+    size_t getSize() const;
+};
+
+#endif //PHYSICSTEST_MAPPED_FILE_H
@@ -0,0 +1,420 @@
+#include "Narrowphase.h"
+
+#include <float.h>
+#include <math.h>
+
+// cross products of nearly parallel edges are too short to give a usable axis
+static const float PARALLEL_EPSILON = 1e-5f;
+
+// an axis replaces the best one found so far only if it separates clearly more,
+// faces are tested first and win ties, they produce more stable manifolds than edges
+static const float AXIS_RELATIVE_TOLERANCE = 0.95f;
+static const float AXIS_ABSOLUTE_TOLERANCE = 0.005f;
+
+static const unsigned int MAX_CLIP_VERTICES = 8;
+
+// clipped points this far in front of the reference face are kept as speculative contacts,
+// so a corner that lifts a little does not drop out of the manifold and come back the next step
+static const float CONTACT_MARGIN = 0.02f;
+
+// feature id layout: edge flag | reference is b | reference face | incident face | clip vertex
+static const unsigned int EDGE_FEATURE = 1 << 13;
+static const unsigned int FLIP_FEATURE = 1 << 12;
+
+enum AxisType {
+    FaceA,
+    FaceB,
+    Edge
+};
+
+struct ClipVertex {
+    vec3 position;
+    // unique among the vertices of one clipped polygon
+    unsigned char id;
+    // edge from this vertex to the next one: 0 - 3 incident face edges, 4 - 7 reference side planes
+    unsigned char edge;
+};
+
+static bool isBetterAxis(float separation, float bestSeparation) {
+    return separation > AXIS_RELATIVE_TOLERANCE * bestSeparation + AXIS_ABSOLUTE_TOLERANCE;
+}
+
+static void calcTangents(vec3 normal, vec3* tangents) {
+
+    if (fabsf(normal.x) >= 0.57735f)
+        tangents[0] = normalize(vec3(normal.y, -normal.x, 0));
+    else
+        tangents[0] = normalize(vec3(0, normal.z, -normal.y));
+
+    tangents[1] = cross(normal, tangents[0]);
+}
+
+// keeps the part of the polygon behind the plane dot(normal, p) <= offset
+static unsigned int clipPolygon(const ClipVertex* in, unsigned int count, vec3 normal, float offset,
+                                unsigned int planeIndex, ClipVertex* out) {
+
+    unsigned int outCount = 0;
+
+    const ClipVertex* previous = &in[count - 1];
+    float previousDistance = dot(normal, previous->position) - offset;
+
+    for (unsigned int index = 0; index < count; index++) {
+
+        const ClipVertex& current = in[index];
+        float currentDistance = dot(normal, current.position) - offset;
+
+        if ((previousDistance <= 0) != (currentDistance <= 0)) {
+
+            ClipVertex vertex;
+            float t = previousDistance / (previousDistance - currentDistance);
+            vertex.position = previous->position + (current.position - previous->position) * t;
+            // a convex polygon crosses a plane on two different edges, so the id is unique
+            vertex.id = (unsigned char)(8 + planeIndex * 8 + previous->edge);
+            // entering continues along the edge that crossed, leaving follows the plane
+            vertex.edge = currentDistance <= 0 ? previous->edge : (unsigned char)(4 + planeIndex);
+
+            out[outCount++] = vertex;
+        }
+
+        if (currentDistance <= 0)
+            out[outCount++] = current;
+
+        previous = &current;
+        previousDistance = currentDistance;
+    }
+
+    return outCount;
+}
+
+// picks 4 points that keep the deepest one and span the largest area
+static unsigned int reducePoints(const ContactPoint* points, unsigned int count, vec3 normal, ContactPoint* out) {
+
+    if (count <= ContactManifold::MAX_POINTS) {
+        for (unsigned int index = 0; index < count; index++)
+            out[index] = points[index];
+        return count;
+    }
+
+    unsigned int first = 0;
+    for (unsigned int index = 1; index < count; index++)
+        if (points[index].penetration > points[first].penetration)
+            first = index;
+
+    unsigned int second = first;
+    float maxDistance = -1;
+    for (unsigned int index = 0; index < count; index++) {
+        vec3 delta = points[index].position - points[first].position;
+        float distance = dot(delta, delta);
+        if (distance > maxDistance) {
+            maxDistance = distance;
+            second = index;
+        }
+    }
+
+    // the last two go to opposite sides of the first edge, largest triangle on each side
+    vec3 edge = points[second].position - points[first].position;
+    unsigned int third = first, fourth = first;
+    float maxArea = 0, minArea = 0;
+    for (unsigned int index = 0; index < count; index++) {
+        float area = dot(cross(edge, points[index].position - points[first].position), normal);
+        if (area > maxArea) {
+            maxArea = area;
+            third = index;
+        }
+        if (area < minArea) {
+            minArea = area;
+            fourth = index;
+        }
+    }
+
+    unsigned int outCount = 0;
+    out[outCount++] = points[first];
+    out[outCount++] = points[second];
+    if (third != first)
+        out[outCount++] = points[third];
+    if (fourth != first)
+        out[outCount++] = points[fourth];
+
+    return outCount;
+}
+
+static void collideFaces(const OrientedBox& reference, const OrientedBox& incident, unsigned int axis, bool flip,
+                         ContactManifold& manifold) {
+
+    vec3 delta = incident.center - reference.center;
+
+    vec3 normal = reference.rotation[axis];
+    unsigned int referenceFace = axis * 2;
+    if (dot(normal, delta) < 0) {
+        normal = -normal;
+        referenceFace++;
+    }
+
+    // incident face is the one facing the reference face the most
+    unsigned int incidentAxis = 0;
+    float maxDot = 0;
+    for (unsigned int index = 0; index < 3; index++) {
+        float d = fabsf(dot(incident.rotation[index], normal));
+        if (d > maxDot) {
+            maxDot = d;
+            incidentAxis = index;
+        }
+    }
+
+    vec3 incidentNormal = incident.rotation[incidentAxis];
+    unsigned int incidentFace = incidentAxis * 2;
+    if (dot(incidentNormal, normal) > 0) {
+        incidentNormal = -incidentNormal;
+        incidentFace++;
+    }
+
+    vec3 incidentCenter = incident.center + incidentNormal * incident.halfSize[incidentAxis];
+    vec3 u = incident.rotation[(incidentAxis + 1) % 3] * incident.halfSize[(incidentAxis + 1) % 3];
+    vec3 v = incident.rotation[(incidentAxis + 2) % 3] * incident.halfSize[(incidentAxis + 2) % 3];
+
+    ClipVertex buffers[2][MAX_CLIP_VERTICES];
+    ClipVertex* polygon = buffers[0];
+    ClipVertex* clipped = buffers[1];
+
+    polygon[0] = { incidentCenter + u + v, 0, 0 };
+    polygon[1] = { incidentCenter - u + v, 1, 1 };
+    polygon[2] = { incidentCenter - u - v, 2, 2 };
+    polygon[3] = { incidentCenter + u - v, 3, 3 };
+    unsigned int count = 4;
+
+    // side planes of the reference face
+    for (unsigned int planeIndex = 0; planeIndex < 4 && count > 0; planeIndex++) {
+
+        unsigned int sideAxis = (axis + 1 + planeIndex / 2) % 3;
+        vec3 sideNormal = reference.rotation[sideAxis] * (planeIndex % 2 == 0 ? 1.0f : -1.0f);
+        float offset = dot(sideNormal, reference.center) + reference.halfSize[sideAxis];
+
+        count = clipPolygon(polygon, count, sideNormal, offset, planeIndex, clipped);
+
+        ClipVertex* swap = polygon;
+        polygon = clipped;
+        clipped = swap;
+    }
+
+    vec3 referenceCenter = reference.center + normal * reference.halfSize[axis];
+    unsigned int featureBase = (flip ? FLIP_FEATURE : 0) | (referenceFace << 9) | (incidentFace << 6);
+
+    ContactPoint points[MAX_CLIP_VERTICES];
+    unsigned int pointCount = 0;
+
+    for (unsigned int index = 0; index < count; index++) {
+
+        float depth = dot(normal, polygon[index].position - referenceCenter);
+        if (depth > CONTACT_MARGIN)
+            continue;
+
+        ContactPoint& point = points[pointCount++];
+        point.position = polygon[index].position - normal * (depth * 0.5f);
+        point.penetration = -depth;
+        point.featureId = featureBase | polygon[index].id;
+    }
+
+    manifold.normal = flip ? -normal : normal;
+    manifold.pointCount = reducePoints(points, pointCount, manifold.normal, manifold.points);
+}
+
+static bool finishManifold(ContactManifold& manifold) {
+
+    if (manifold.pointCount == 0)
+        return false;
+
+    calcTangents(manifold.normal, manifold.tangents);
+
+    for (unsigned int index = 0; index < manifold.pointCount; index++) {
+        manifold.points[index].normalImpulse = 0;
+        manifold.points[index].tangentImpulse[0] = 0;
+        manifold.points[index].tangentImpulse[1] = 0;
+    }
+
+    return true;
+}
+
+// the edge of the box along the axis that lies furthest in the direction
+static vec3 getSupportEdge(const OrientedBox& box, unsigned int axis, vec3 direction, unsigned int* edgeId) {
+
+    vec3 center = box.center;
+    unsigned int id = axis * 4;
+
+    for (unsigned int offset = 1; offset < 3; offset++) {
+        unsigned int other = (axis + offset) % 3;
+        if (dot(box.rotation[other], direction) >= 0) {
+            center += box.rotation[other] * box.halfSize[other];
+        } else {
+            center -= box.rotation[other] * box.halfSize[other];
+            id |= offset;
+        }
+    }
+
+    *edgeId = id;
+    return center;
+}
+
+static void collideEdges(const OrientedBox& a, const OrientedBox& b, unsigned int axisA, unsigned int axisB,
+                         float separation, ContactManifold& manifold) {
+
+    vec3 directionA = a.rotation[axisA], directionB = b.rotation[axisB];
+
+    vec3 normal = normalize(cross(directionA, directionB));
+    if (dot(normal, b.center - a.center) < 0)
+        normal = -normal;
+
+    unsigned int edgeA, edgeB;
+    vec3 centerA = getSupportEdge(a, axisA, normal, &edgeA);
+    vec3 centerB = getSupportEdge(b, axisB, -normal, &edgeB);
+
+    // closest points of the two edge lines, clamped to the edges
+    vec3 r = centerA - centerB;
+    float d = dot(directionA, directionB);
+    float c = dot(directionA, r), f = dot(directionB, r);
+    float denominator = 1.0f - d * d;
+
+    float s = 0, t = 0;
+    if (denominator > PARALLEL_EPSILON) {
+        s = (d * f - c) / denominator;
+        t = (f - d * c) / denominator;
+    }
+
+    s = glm::clamp(s, -a.halfSize[axisA], a.halfSize[axisA]);
+    t = glm::clamp(t, -b.halfSize[axisB], b.halfSize[axisB]);
+
+    vec3 pointA = centerA + directionA * s;
+    vec3 pointB = centerB + directionB * t;
+
+    manifold.normal = normal;
+    manifold.pointCount = 1;
+
+    ContactPoint& point = manifold.points[0];
+    point.position = (pointA + pointB) * 0.5f;
+    point.penetration = -separation;
+    point.featureId = EDGE_FEATURE | (edgeA << 4) | edgeB;
+}
+
+bool collideBoxes(const OrientedBox& a, const OrientedBox& b, ContactManifold& manifold) {
+
+    vec3 delta = b.center - a.center;
+
+    // b's axes in a's frame
+    float c[3][3], absC[3][3];
+    bool parallel = false;
+
+    for (unsigned int i = 0; i < 3; i++) {
+        for (unsigned int j = 0; j < 3; j++) {
+            c[i][j] = dot(a.rotation[i], b.rotation[j]);
+            absC[i][j] = fabsf(c[i][j]) + PARALLEL_EPSILON;
+            if (absC[i][j] >= 1.0f)
+                parallel = true;
+        }
+    }
+
+    vec3 deltaA = vec3(dot(delta, a.rotation[0]), dot(delta, a.rotation[1]), dot(delta, a.rotation[2]));
+
+    AxisType bestType = FaceA;
+    unsigned int bestAxisA = 0, bestAxisB = 0;
+    float bestSeparation = -FLT_MAX;
+
+    for (unsigned int i = 0; i < 3; i++) {
+
+        float rb = b.halfSize.x * absC[i][0] + b.halfSize.y * absC[i][1] + b.halfSize.z * absC[i][2];
+        float separation = fabsf(deltaA[i]) - (a.halfSize[i] + rb);
+        if (separation > 0)
+            return false;
+
+        if (separation > bestSeparation) {
+            bestSeparation = separation;
+            bestAxisA = i;
+        }
+    }
+
+    for (unsigned int j = 0; j < 3; j++) {
+
+        float ra = a.halfSize.x * absC[0][j] + a.halfSize.y * absC[1][j] + a.halfSize.z * absC[2][j];
+        float separation = fabsf(dot(delta, b.rotation[j])) - (ra + b.halfSize[j]);
+        if (separation > 0)
+            return false;
+
+        if (isBetterAxis(separation, bestSeparation)) {
+            bestType = FaceB;
+            bestSeparation = separation;
+            bestAxisB = j;
+        }
+    }
+
+    // edge axes add nothing when an axis pair is parallel, the face axes already cover it
+    if (!parallel) {
+        for (unsigned int i = 0; i < 3; i++) {
+
+            unsigned int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+
+            for (unsigned int j = 0; j < 3; j++) {
+
+                unsigned int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+
+                float ra = a.halfSize[i1] * absC[i2][j] + a.halfSize[i2] * absC[i1][j];
+                float rb = b.halfSize[j1] * absC[i][j2] + b.halfSize[j2] * absC[i][j1];
+                float distance = deltaA[i2] * c[i1][j] - deltaA[i1] * c[i2][j];
+
+                // the axis cross(a_i, b_j) has length sin(angle), separation is measured along the unit axis
+                float length = sqrtf(1.0f - c[i][j] * c[i][j]);
+                if (length < PARALLEL_EPSILON)
+                    continue;
+
+                float separation = (fabsf(distance) - (ra + rb)) / length;
+                if (separation > 0)
+                    return false;
+
+                if (isBetterAxis(separation, bestSeparation)) {
+                    bestType = Edge;
+                    bestSeparation = separation;
+                    bestAxisA = i;
+                    bestAxisB = j;
+                }
+            }
+        }
+    }
+
+    switch (bestType) {
+        case FaceA:
+            collideFaces(a, b, bestAxisA, false, manifold);
+            break;
+        case FaceB:
+            collideFaces(b, a, bestAxisB, true, manifold);
+            break;
+        case Edge:
+            collideEdges(a, b, bestAxisA, bestAxisB, bestSeparation, manifold);
+            break;
+    }
+
+    return finishManifold(manifold);
+}
+
+bool collideBoxWall(const OrientedBox& box, vec3 normal, float offset, ContactManifold& manifold) {
+
+    ContactPoint points[8];
+    unsigned int pointCount = 0;
+
+    for (unsigned int corner = 0; corner < 8; corner++) {
+
+        vec3 position = box.center;
+        for (unsigned int axis = 0; axis < 3; axis++)
+            position += box.rotation[axis] * (box.halfSize[axis] * ((corner >> axis) & 1 ? -1.0f : 1.0f));
+
+        float penetration = dot(normal, position) - offset;
+        if (penetration < -CONTACT_MARGIN)
+            continue;
+
+        ContactPoint& point = points[pointCount++];
+        point.position = position - normal * (penetration * 0.5f);
+        point.penetration = penetration;
+        point.featureId = corner;
+    }
+
+    manifold.normal = normal;
+    manifold.pointCount = reducePoints(points, pointCount, normal, manifold.points);
+
+    return finishManifold(manifold);
+}
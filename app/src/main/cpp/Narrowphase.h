@@ -0,0 +1,59 @@
+#ifndef PHYSICSTEST_NARROWPHASE_H
+#define PHYSICSTEST_NARROWPHASE_H
+
+#include <glm/glm.hpp>
+
+using namespace glm;
+
+struct OrientedBox {
+    vec3 center;
+    mat3 rotation;
+    vec3 halfSize;
+};
+
+struct ContactPoint {
+    // world space, halfway between the two surfaces
+    vec3 position;
+    // negative for speculative points that are still slightly apart
+    float penetration;
+    // identifies the pair of features that produced the point,
+    // stays the same between steps while the same face, edge or vertex keeps touching
+    unsigned int featureId;
+
+    // impulses applied along the normal and the two tangents, kept between steps
+    float normalImpulse;
+    float tangentImpulse[2];
+};
+
+struct ContactManifold {
+    static const unsigned int MAX_POINTS = 4;
+
+    // walls take the indices from FIRST_WALL up (min x, max x, min y, max y, min z, max z),
+    // they never move and always sit in b
+    static const unsigned int FIRST_WALL = 0xFFFFFFF0;
+    static const unsigned int WALL_COUNT = 6;
+
+    static bool isWall(unsigned int index) {
+        return index >= FIRST_WALL;
+    }
+
+    // dense body indices, a < b
+    unsigned int a, b;
+
+    // from a to b
+    vec3 normal;
+    vec3 tangents[2];
+
+    unsigned int pointCount;
+    ContactPoint points[MAX_POINTS];
+};
+
+// separating axis test over the 15 axes of two boxes,
+// fills the manifold (normal, tangents and up to 4 points with zero impulses) if they overlap
+// allocation free, a and b of the manifold are left untouched
+bool collideBoxes(const OrientedBox& a, const OrientedBox& b, ContactManifold& manifold);
+
+// corners of the box behind the wall plane dot(normal, p) = offset, the normal points into the wall
+bool collideBoxWall(const OrientedBox& box, vec3 normal, float offset, ContactManifold& manifold);
+
+#endif //PHYSICSTEST_NARROWPHASE_H
@@ -1,357 +1,556 @@
 #include "Physics.h"
 
+#include <string.h>
+
 #include "log.h"
-#include "exceptionUtils.h"
+#include "Profiler.h"
+
+#include <algorithm>
 
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/quaternion.hpp>
 
-#include "AssetManager.h"
+extern "C" {
+#include "generalUtils.h"
+}
 
 #define PHYSICS_TAG "PT_PHYSICS"
 
-Physics::Physics() {
+constexpr float Physics::WALL_PAIR_MARGIN;
+constexpr float Physics::GRAVITY_WAKE_THRESHOLD;
+constexpr float Physics::MAX_SUB_STEP_TRAVEL;
+constexpr float Physics::SUB_STEP_PENETRATION;
+
+Physics::Physics() : broadphaseType(UniformGrid), broadphase(nullptr), threadCount(0), jobs(nullptr), timings(),
+                     maxSubSteps(DEFAULT_MAX_SUB_STEPS), lastPenetration(0), sweepFastBodies(false),
+                     storage(nullptr), stateRestored(false) {
 
 }
 
+void Physics::setStorage(StateStorage* storage) {
+    this->storage = storage;
+}
+
 void Physics::initialize() {
 
     if (this->initialized == 1)
         return;
 
     this->gravity = normalize(vec3(0, 0, -1)) * 9.8f;
+    this->restingGravity = this->gravity;
+    this->lastPenetration = 0;
 
     mat3 rotation = rotate(mat4(1.f), radians(0.0f), normalize(vec3(0, 1, 0)));
 
-    this->cube = new Cube({ 0, 0, 0 }, rotation, { 1, 1, 1 });
-    this->walls = new Cube({ 0, 0, 0 }, mat4(1.0f), { 4.3f, 4.3f, 4.3f });
+    this->walls = new Cube({ 0, 0, 0 }, quat(1, 0, 0, 0), { 4.3f, 4.3f, 4.3f });
+
+    addCube({ 0, 0, 0 }, quat_cast(rotation), { 1, 1, 1 }, 1.0f);
 
-    this->cubePhysics = new PhysicsData(this->cube, this->walls, 1.0f);
+    this->broadphase = createBroadphase(broadphaseType, getWallsBounds());
+
+    this->jobs = new JobSystem(threadCount);
+    this->solver.setJobSystem(jobs);
 
     loadSimulationState();
 
+    if (this->storage != nullptr)
+        this->checkpointer.start(this->storage, STATE_FILE_NAME);
+
     this->initialized = 1;
 }
 
 void Physics::loadSimulationState() {
 
-    SerializedScene scene;
-    if (!AssetManager::getInstance().loadExternalBinaryFile(STATE_FILE_NAME, &scene, sizeof(scene)))
+    this->stateRestored = false;
+
+    // mapped, the snapshot's arrays are copied straight out of the page cache
+    MappedFile file;
+    if (this->storage == nullptr || !this->storage->mapBinaryFile(STATE_FILE_NAME, file))
+        return;
+
+    if (loadSnapshot(file.getData(), file.getSize())) {
+        this->stateRestored = true;
         return;
+    }
+
+    if (file.getSize() == sizeof(SerializedScene)) {
+
+        SerializedScene scene;
+        memcpy(&scene, file.getData(), sizeof(scene));
+
+        importLegacyState(scene);
+        this->stateRestored = true;
+        return;
+    }
 
-    this->cube->loadFromState(scene.cubeState);
-    this->cubePhysics->loadFromState(scene.cubePhysicsState);
+    print_log(ANDROID_LOG_WARN, PHYSICS_TAG, "Unreadable %s of %u bytes, starting over", STATE_FILE_NAME.c_str(),
+              (unsigned int) file.getSize());
+
+    // kept aside for a look, but out of the way of the next launch
+    file.close();
+    if (!this->storage->renameBinaryFile(STATE_FILE_NAME, BAD_STATE_FILE_NAME))
+        print_log(ANDROID_LOG_WARN, PHYSICS_TAG, "Can't move %s aside", STATE_FILE_NAME.c_str());
+}
+
+void Physics::importLegacyState(const SerializedScene& scene) {
+
+    // the old file only holds the first body
+    if (world.getBodyCount() > 0)
+        this->world.getBodies().loadFromState(0, scene.cubeState, scene.cubePhysicsState);
 
     setGravity(scene.gravity);
 }
 
 void Physics::saveSimulationState() {
 
-    SerializedScene scene = { };
+    // lets the checkpoint in flight finish first, both go through the same temporary file
+    this->checkpointer.stop();
 
-    scene.gravity = getGravity();
+    if (this->storage == nullptr)
+        return;
 
-    this->cube->saveToState(&scene.cubeState);
-    this->cubePhysics->saveToState(&scene.cubePhysicsState);
+    vector<unsigned char> snapshot;
+    saveSnapshot(snapshot);
 
-    AssetManager::getInstance().saveExternalBinaryFile(STATE_FILE_NAME, &scene, sizeof(scene));
+    if (!this->storage->saveBinaryFile(STATE_FILE_NAME, snapshot.data(), (unsigned int) snapshot.size()))
+        print_log(ANDROID_LOG_WARN, PHYSICS_TAG, "Can't save %s", STATE_FILE_NAME.c_str());
 }
 
-const Cube* Physics::getCube() {
-    return cube;
+bool Physics::isStateRestored() {
+    return this->stateRestored;
 }
 
-const Cube* Physics::getWalls() {
-    return walls;
-}
+bool Physics::checkpoint() {
 
-void Physics::setGravity(vec3 gravity) {
-    this->gravity = gravity;
-}
+    PROFILE_ZONE("Physics::checkpoint");
 
-vec3 Physics::getGravity() {
-    return this->gravity;
+    return this->checkpointer.checkpoint([this] (vector<unsigned char>& buffer) {
+        saveSnapshot(buffer);
+    });
 }
 
-void Physics::finalize() {
+void Physics::saveSnapshot(vector<unsigned char>& snapshot) {
 
-    if (this->initialized == 0)
-        return;
+    const BodyStorage& bodies = world.getBodies();
+    const vector<ContactManifold>& manifolds = contacts.getManifolds();
 
-    saveSimulationState();
+    SnapshotHeader header = { };
+    layoutSnapshot(header, bodies.size(), BodyStorage::getStateArrayCount(), (unsigned int) manifolds.size(),
+                   sizeof(ContactManifold));
 
-    delete this->cubePhysics;
-    this->cubePhysics = nullptr;
+    for (unsigned int axis = 0; axis < 3; axis++) {
+        header.gravity[axis] = this->gravity[axis];
+        header.restingGravity[axis] = this->restingGravity[axis];
+    }
 
-    delete this->cube;
-    this->cube = nullptr;
+    header.lastPenetration = this->lastPenetration;
+    header.velocityIterations = getVelocityIterations();
+    header.positionIterations = getPositionIterations();
+    header.maxSubSteps = this->maxSubSteps;
+    header.broadphaseType = this->broadphaseType;
 
-    delete this->walls;
-    this->walls = nullptr;
+    // zeroed, so the padding between sections is deterministic
+    snapshot.assign(header.fileSize, 0);
+    unsigned char* data = snapshot.data();
 
-    this->initialized = 0;
+    memcpy(data, &header, sizeof(header));
+    bodies.saveState(data + header.floatArraysOffset, header.floatArrayStride, data + header.awakeOffset);
+    if (!manifolds.empty())
+        memcpy(data + header.manifoldsOffset, manifolds.data(), manifolds.size() * sizeof(ContactManifold));
+
+    if (!isLittleEndianHost())
+        swapSnapshotByteOrder(data, header);
 }
 
-void Physics::step(double dt) {
+bool Physics::loadSnapshot(const unsigned char* snapshot, size_t size) {
+
+    if (size < sizeof(SnapshotHeader))
+        return false;
+
+    SnapshotHeader header;
+    memcpy(&header, snapshot, sizeof(header));
+
+    if (!isLittleEndianHost())
+        swapSnapshotHeader(header);
+
+    if (!checkSnapshotHeader(header, size, BodyStorage::getStateArrayCount(), sizeof(ContactManifold)) ||
+        header.broadphaseType > UniformGrid)
+        return false;
+
+    // big endian hosts work on a swapped copy
+    vector<unsigned char> swapped;
+    if (!isLittleEndianHost()) {
+        swapped.assign(snapshot, snapshot + header.fileSize);
+        swapSnapshotByteOrder(swapped.data(), header);
+        snapshot = swapped.data();
+    }
+
+    // the solver indexes bodies with these, a manifold pointing anywhere else rejects the whole snapshot,
+    // and the contact cache matches them to the next pairs in one walk, which takes them sorted by pair with a < b
+    // and every pair once
+    const ContactManifold* manifolds = (const ContactManifold*)(snapshot + header.manifoldsOffset);
+    for (unsigned int index = 0; index < header.manifoldCount; index++) {
+
+        const ContactManifold& manifold = manifolds[index];
+
+        bool validB = manifold.b < header.bodyCount ||
+                      (ContactManifold::isWall(manifold.b) &&
+                       manifold.b < ContactManifold::FIRST_WALL + ContactManifold::WALL_COUNT);
+
+        if (manifold.a >= header.bodyCount || !validB || manifold.pointCount > ContactManifold::MAX_POINTS)
+            return false;
+
+        if (manifold.a >= manifold.b)
+            return false;
+
+        const ContactManifold* last = index > 0 ? &manifolds[index - 1] : nullptr;
+        if (last != nullptr && (last->a > manifold.a || (last->a == manifold.a && last->b >= manifold.b)))
+            return false;
+    }
 
-    unsigned int SUB_STEP_COUNT = 1;
-    unsigned int DEBUG_SPEED = 1;
-    double subDt = dt / SUB_STEP_COUNT;
+    this->world.loadState(header.bodyCount, snapshot + header.floatArraysOffset, header.floatArrayStride,
+                          snapshot + header.awakeOffset);
+    this->contacts.setManifolds(manifolds, header.manifoldCount);
 
-    for (unsigned int debugCounter = 0; debugCounter < DEBUG_SPEED; debugCounter++)
-        for (unsigned int counter = 0; counter < SUB_STEP_COUNT; counter++)
-            subStep(subDt);
+    this->gravity = vec3(header.gravity[0], header.gravity[1], header.gravity[2]);
+    this->restingGravity = vec3(header.restingGravity[0], header.restingGravity[1], header.restingGravity[2]);
+    this->lastPenetration = header.lastPenetration;
+
+    setVelocityIterations(header.velocityIterations);
+    setPositionIterations(header.positionIterations);
+    setMaxSubSteps(header.maxSubSteps);
+
+    // a fresh broadphase, whatever it kept about the old bodies is meaningless now
+    this->broadphaseType = (BroadphaseType) header.broadphaseType;
+    if (this->broadphase != nullptr) {
+        delete this->broadphase;
+        this->broadphase = createBroadphase(broadphaseType, getWallsBounds());
+    }
+
+    // sleeping bodies never refresh their boxes, so all of them are computed once here
+    const BodyStorage& bodies = world.getBodies();
+    aabbs.resize(bodies.size());
+    for (unsigned int index = 0; index < bodies.size(); index++)
+        aabbs[index] = bodies.getAabb(index);
+
+    this->pairs.clear();
+
+    return true;
 }
 
-void Physics::subStep(double dt) {
+BodyHandle Physics::addCube(vec3 position, quat orientation, vec3 size, float mass) {
+    return this->world.addBody(position, orientation, size, mass);
+}
 
-    this->cubePhysics->applyGravity(gravity, dt);
-    this->cubePhysics->processCollisions();
-    this->cubePhysics->integrate(dt);
-    // this->cubePhysics->applyDamping(dt, 0.1);
+void Physics::removeBody(BodyHandle handle) {
+    this->world.removeBody(handle);
+    // the last body took the removed one's index, cached manifolds would refer to the wrong bodies,
+    // and whatever rested on the removed body has to fall
+    this->contacts.clear();
+    this->world.getBodies().wakeAll();
 }
 
-// PhysicsData
+void Physics::spawnCubes(unsigned int count, float mass) {
 
-PhysicsData::PhysicsData(Cube* cube, Cube* walls, float mass) {
+    if (count == 0)
+        return;
 
-    this->cube = cube;
-    this->walls = walls;
+    // the lattice takes the whole box, the cube initialize adds at the center would sit inside its boxes
+    this->world.clear();
+    this->contacts.clear();
 
-    this->linearVelocity = { 0, 0, 0 };
-    this->angularVelocity = { 0, 0, 0 };
+    vec3 wallsSize = walls->getSize();
 
-    this->invMass = 1.0f / mass;
+    // smallest cubic lattice that holds all the bodies, every box takes 80% of its cell
+    unsigned int perAxis = 1;
+    while (perAxis * perAxis * perAxis < count)
+        perAxis++;
 
-    vec3 size = cube->getSize();
-    vec3 sizeSq = size * size;
+    vec3 cellSize = wallsSize / (float)perAxis;
+    vec3 size = cellSize * 0.8f;
+    vec3 origin = walls->getLeftBottomNear() + cellSize * 0.5f;
 
-    vec3 inertia = {
-        mass / 12.0f * (sizeSq.y + sizeSq.z),
-        mass / 12.0f * (sizeSq.x + sizeSq.z),
-        mass / 12.0f * (sizeSq.x + sizeSq.y)
-    };
+    this->world.reserve(count);
 
-    // inertia *= 0.5f;
+    for (unsigned int index = 0; index < count; index++) {
 
-    this->localInvInertiaTensor = scale(mat4(1.0f), 1.0f / inertia);
+        unsigned int x = index % perAxis;
+        unsigned int y = (index / perAxis) % perAxis;
+        unsigned int z = index / (perAxis * perAxis);
 
-    updateInertiaTensor();
+        vec3 position = origin + cellSize * vec3((float)x, (float)y, (float)z);
+
+        addCube(position, quat(1, 0, 0, 0), size, mass);
+    }
 }
 
-void PhysicsData::integrateTransforms(vec3 positionDelta, vec3 rotationDelta) {
+void Physics::setBroadphase(BroadphaseType type) {
+
+    this->broadphaseType = type;
+
+    if (this->initialized == 0)
+        return;
+
+    delete this->broadphase;
+    this->broadphase = createBroadphase(type, getWallsBounds());
+}
 
-    this->cube->integrateTransforms(positionDelta, rotationDelta);
-    this->updateInertiaTensor();
+const vector<BodyPair>& Physics::getPairs() {
+    return pairs;
 }
 
-void PhysicsData::updateInertiaTensor() {
+const vector<ContactManifold>& Physics::getManifolds() {
+    return contacts.getManifolds();
+}
 
-    mat3 rotation = cube->getRotation();
+void Physics::setVelocityIterations(unsigned int iterations) {
+    this->solver.setVelocityIterations(iterations);
+}
 
-    this->worldInvInertiaTensor = rotation * this->localInvInertiaTensor * transpose(rotation);
+unsigned int Physics::getVelocityIterations() {
+    return this->solver.getVelocityIterations();
 }
 
-void PhysicsData::applyGravity(vec3 gravity, double dt) {
-    this->linearVelocity += gravity * (float)dt;
+void Physics::setPositionIterations(unsigned int iterations) {
+    this->solver.setPositionIterations(iterations);
 }
 
-void PhysicsData::applyPseudoImpulse(vec3 impulse, vec3 localPoint) {
-    this->integrateTransforms(this->invMass * impulse, this->worldInvInertiaTensor * cross(localPoint, impulse));
+unsigned int Physics::getPositionIterations() {
+    return this->solver.getPositionIterations();
 }
 
-void PhysicsData::applyImpulse(vec3 impulse, vec3 localPoint) {
-    this->linearVelocity += this->invMass * impulse;
-    this->angularVelocity += this->worldInvInertiaTensor * cross(localPoint, impulse);
+void Physics::setThreadCount(unsigned int count) {
+
+    this->threadCount = count;
+
+    if (this->initialized == 0)
+        return;
+
+    delete this->jobs;
+    this->jobs = new JobSystem(count);
+    this->solver.setJobSystem(jobs);
 }
 
-bool isZeroVec(vec3 v) {
-    float manhattanDist = fabs(v.x) + fabs(v.y) + fabs(v.z);
-    return manhattanDist <= 10e-5;
+void Physics::setMaxSubSteps(unsigned int count) {
+    this->maxSubSteps = std::max(1u, count);
 }
 
-void PhysicsData::processCollisions() {
+unsigned int Physics::getMaxSubSteps() {
+    return this->maxSubSteps;
+}
 
-    vec3 leftBottomNear = walls->getLeftBottomNear();
-    vec3 rightTopFar = walls->getRightTopFar();
+unsigned int Physics::getThreadCount() {
+    return jobs != nullptr ? jobs->getThreadCount() : threadCount;
+}
 
-    vec3 errorPointSum;
-    float errorSum, errorMin;
+const PhysicsTimings& Physics::getTimings() {
+    return timings;
+}
 
-    const unsigned int normalCount = 3;
-    const vec3 normals[normalCount] = {
-            { 1, 0, 0 },
-            { 0, 1, 0 },
-            { 0, 0, 1 }
-    };
+uint64_t Physics::calcStateHash() {
 
-    const vec3* points = this->cube->getPoints();
-    for (unsigned int normalIndex = 0; normalIndex < normalCount; normalIndex++) {
+    // the gravity drives the next step, so it belongs to the state
+    float gravity[3] = { this->gravity.x, this->gravity.y, this->gravity.z };
+    uint64_t hash = hashStateWords(STATE_HASH_SEED, gravity, 3);
 
-        vec3 normal = normals[normalIndex];
+    return this->world.getBodies().calcStateHash(hash);
+}
 
-        errorPointSum = {0, 0, 0};
-        errorSum = 0;
-        errorMin = 0;
+const World& Physics::getWorld() {
+    return world;
+}
 
-        for (unsigned int pointIndex = 0; pointIndex < Cube::POINTS_COUNT; pointIndex++) {
 
-            vec3 point = points[pointIndex];
+void Physics::saveRenderState(RenderState& state) {
 
-            float errorDist = glm::min(dot(point - leftBottomNear, normal), 0.0f) +
-                          glm::max(dot(point - rightTopFar, normal), 0.0f);
+    const BodyStorage& bodies = this->world.getBodies();
 
-            if (fabs(errorDist) > 0) {
-                errorSum += errorDist;
-                errorPointSum += point * errorDist;
-                errorMin = std::max(fabs(errorMin), fabs(errorDist)) * sign(errorDist);
-            }
-        }
+    state.positions.resize(bodies.size());
+    state.orientations.resize(bodies.size());
+    state.sizes.resize(bodies.size());
 
-        if (fabs(errorSum) > 0) {
-
-            vec3 errorNormal = normal;
-
-            vec3 errorPoint = errorPointSum / errorSum;
-
-            vec3 linearVelocityAtPoint, velocityErrorCorrection, temp, impulse;
-
-            vec3 localErrorPoint = errorPoint - this->cube->getPosition();
-
-            // tangent impulse
-            linearVelocityAtPoint =
-                    this->linearVelocity + cross(this->angularVelocity, localErrorPoint);
-            vec3 c = cross(errorNormal, linearVelocityAtPoint);
-            if (!isZeroVec(c)) {
-                vec3 errorTangent = normalize(cross(c, errorNormal));
-                if (!isZeroVec(errorTangent)) {
-                    velocityErrorCorrection =
-                            (-(0.0f + FRICTION)) *
-                            (dot(linearVelocityAtPoint, errorTangent) * errorTangent);
-                    temp = this->worldInvInertiaTensor * cross(localErrorPoint, errorTangent);
-                    impulse = velocityErrorCorrection /
-                              (this->invMass + dot(errorTangent, cross(temp, localErrorPoint)));
-                    applyImpulse(impulse, localErrorPoint);
-                }
-            }
-
-            // normal impulse
-            linearVelocityAtPoint =
-                    this->linearVelocity + cross(this->angularVelocity, localErrorPoint);
-            velocityErrorCorrection =
-                    (-(1.0f + RESTITUTION)) *
-                    (dot(linearVelocityAtPoint, errorNormal) * errorNormal);
-            temp = this->worldInvInertiaTensor * cross(localErrorPoint, errorNormal);
-
-            impulse = (velocityErrorCorrection) /
-                      (this->invMass + dot(errorNormal, cross(temp, localErrorPoint)));
-            applyImpulse(impulse, localErrorPoint);
-
-            vec3 error = errorNormal * errorMin;
-
-            // normal error correction
-            linearVelocityAtPoint =
-                    this->linearVelocity + cross(this->angularVelocity, localErrorPoint);
-            velocityErrorCorrection = -(error * 0.1f);
-            temp = this->worldInvInertiaTensor * cross(localErrorPoint, errorNormal);
-
-            impulse = velocityErrorCorrection /
-                      (this->invMass + dot(errorNormal, cross(temp, localErrorPoint)));
-            applyPseudoImpulse(impulse, localErrorPoint);
-        }
+    for (unsigned int index = 0; index < bodies.size(); index++) {
+        state.positions[index] = bodies.getPosition(index);
+        state.orientations[index] = bodies.getOrientation(index);
+        state.sizes[index] = bodies.getSize(index);
     }
+
+    state.gravity = this->gravity;
 }
 
-void PhysicsData::integrate(double dt) {
-    this->integrateTransforms(this->linearVelocity * (float)dt, this->angularVelocity * (float)dt);
+const Cube* Physics::getWalls() {
+    return walls;
 }
 
-void PhysicsData::applyDamping(double dt, float damping) {
+void Physics::setGravity(vec3 gravity) {
 
-    float m = 1.0f - (float)dt * damping;
+    this->gravity = gravity;
 
-    this->linearVelocity *= m;
-    this->angularVelocity *= m;
+    if (length(gravity - restingGravity) > GRAVITY_WAKE_THRESHOLD) {
+        this->world.getBodies().wakeAll();
+        this->restingGravity = gravity;
+    }
 }
 
-void PhysicsData::loadFromState(SerializedPhysics state) {
-
+vec3 Physics::getGravity() {
+    return this->gravity;
 }
 
-void PhysicsData::saveToState(SerializedPhysics* state) {
+void Physics::finalize() {
 
-}
+    if (this->initialized == 0)
+        return;
 
-// Cube
+    saveSimulationState();
 
-Cube::Cube(vec3 position, mat3 rotation, vec3 size) :
-    position(position), rotation(rotation), size(size) {
-    calcPoints();
-}
+    this->world.clear();
+    this->contacts.clear();
 
-void Cube::calcPoints() {
+    delete this->broadphase;
+    this->broadphase = nullptr;
 
-    vec3 CUBE_POINTS[8] = {
-            {  0.50f,  0.50f,  0.50f },
-            {  0.50f, -0.50f,  0.50f },
-            {  0.50f,  0.50f, -0.50f },
-            {  0.50f, -0.50f, -0.50f },
+    this->solver.setJobSystem(nullptr);
+    delete this->jobs;
+    this->jobs = nullptr;
 
-            { -0.50f,  0.50f,  0.50f },
-            { -0.50f, -0.50f,  0.50f },
-            { -0.50f,  0.50f, -0.50f },
-            { -0.50f, -0.50f, -0.50f },
-    };
+    delete this->walls;
+    this->walls = nullptr;
 
-    for (unsigned int pointIndex = 0; pointIndex < POINTS_COUNT; pointIndex++) {
-        points[pointIndex] = (rotation * (CUBE_POINTS[pointIndex] * size)) + position;
-    }
+    this->initialized = 0;
 }
 
-const vec3 Cube::getPosition() const {
-    return this->position;
-}
+void Physics::step(double dt) {
 
-const mat3 Cube::getRotation() const {
-    return this->rotation;
-}
+    PROFILE_ZONE("Physics::step");
 
-const vec3 Cube::getSize() const {
-    return this->size;
+    this->timings = PhysicsTimings();
+    double start = getTime();
+
+    float travel = this->world.getBodies().calcMaxRelativeTravel(this->gravity, dt);
+
+    unsigned int subStepCount = chooseSubStepCount(travel);
+    double subDt = dt / subStepCount;
+
+    this->sweepFastBodies = travel / subStepCount > ContinuousCollision::FAST_TRAVEL;
+
+    for (unsigned int counter = 0; counter < subStepCount; counter++)
+        subStep(subDt);
+
+    this->lastPenetration = findMaxPenetration();
+
+    this->timings.subStepCount = subStepCount;
+    this->timings.total = getTime() - start;
 }
 
-const vec3* Cube::getPoints() const {
-    return this->points;
+unsigned int Physics::chooseSubStepCount(float travel) {
+
+    unsigned int byTravel = (unsigned int) ceil(travel / MAX_SUB_STEP_TRAVEL);
+    unsigned int byPenetration = (unsigned int) ceil(this->lastPenetration / SUB_STEP_PENETRATION);
+
+    return std::max(1u, std::min(std::max(byTravel, byPenetration), this->maxSubSteps));
 }
 
-const vec3 Cube::getLeftBottomNear() const {
-    return position - size * 0.5f;
+float Physics::findMaxPenetration() {
+
+    float maxPenetration = 0;
+
+    for (const ContactManifold& manifold : this->contacts.getManifolds())
+        for (unsigned int index = 0; index < manifold.pointCount; index++)
+            maxPenetration = std::max(maxPenetration, manifold.points[index].penetration);
+
+    return maxPenetration;
 }
 
-const vec3 Cube::getRightTopFar() const {
-    return position + size * 0.5f;
+Aabb Physics::getWallsBounds() {
+    return { walls->getLeftBottomNear(), walls->getRightTopFar() };
 }
 
-void Cube::integrateTransforms(vec3 positionDelta, vec3 rotationDelta) {
+void Physics::updateBroadphase() {
+
+    const BodyStorage& bodies = world.getBodies();
 
-    this->position += positionDelta;
+    aabbs.resize(bodies.size());
+    bodies.calcAabbs(aabbs.data());
 
-    quat rotation = quat_cast(this->getRotation());
-    quat rotationDeltaQ = quat(0, rotationDelta.x, rotationDelta.y, rotationDelta.z);
-    rotation += (rotationDeltaQ * rotation) * 0.5f;
+    broadphase->update(aabbs.data(), bodies.size());
 
-    this->rotation = mat3_cast(normalize(rotation));
+    pairs.clear();
+    broadphase->findPairs(pairs);
 
-    this->calcPoints();
+    findWallPairs();
 }
 
-void Cube::loadFromState(SerializedCube state) {
-    this->position = state.position;
-    this->rotation = state.rotation;
-    this->calcPoints();
+void Physics::findWallPairs() {
+
+    Aabb inner = getWallsBounds().expand(-WALL_PAIR_MARGIN);
+
+    for (unsigned int index = 0; index < aabbs.size(); index++) {
+
+        const Aabb& aabb = aabbs[index];
+
+        for (unsigned int axis = 0; axis < 3; axis++) {
+            if (aabb.min[axis] < inner.min[axis])
+                pairs.push_back({ index, ContactManifold::FIRST_WALL + axis * 2 });
+            if (aabb.max[axis] > inner.max[axis])
+                pairs.push_back({ index, ContactManifold::FIRST_WALL + axis * 2 + 1 });
+        }
+    }
 }
 
-void Cube::saveToState(SerializedCube* state) {
-    state->position = this->position;
-    state->rotation = this->rotation;
-}
\ No newline at end of file
+void Physics::subStep(double dt) {
+
+    PROFILE_ZONE("Physics::subStep");
+
+    BodyStorage& bodies = world.getBodies();
+    vector<ContactManifold>& manifolds = contacts.getManifolds();
+
+    double time = getTime();
+
+    bodies.applyGravity(gravity, dt);
+    updateBroadphase();
+
+    double broadphaseEnd = getTime();
+    contacts.update(pairs, bodies, getWallsBounds());
+
+    double narrowphaseEnd = getTime();
+    islands.build(manifolds, bodies);
+    const vector<unsigned int>& awakeManifolds = islands.getAwakeManifolds();
+    const vector<unsigned int>& awakeGroups = islands.getAwakeGroupOffsets();
+
+    double islandsEnd = getTime();
+    solver.solveVelocities(manifolds, awakeManifolds, awakeGroups, bodies, (float)dt);
+
+    double velocitySolverEnd = getTime();
+    if (sweepFastBodies)
+        ccd.sweep(bodies, aabbs, *broadphase, getWallsBounds(), dt);
+
+    bodies.integrate(dt);
+    // bodies.applyDamping(dt, 0.1);
+
+    if (sweepFastBodies)
+        ccd.clampMotion(bodies);
+
+    double integrationEnd = getTime();
+    solver.solvePositions(manifolds, bodies);
+
+    double positionSolverEnd = getTime();
+    islands.updateSleeping(bodies, (float)dt);
+
+    double sleepingEnd = getTime();
+
+    PROFILE_RECORD("broadphase", time, broadphaseEnd);
+    PROFILE_RECORD("narrowphase", broadphaseEnd, narrowphaseEnd);
+    PROFILE_RECORD("islands", narrowphaseEnd, islandsEnd);
+    PROFILE_RECORD("velocity solver", islandsEnd, velocitySolverEnd);
+    PROFILE_RECORD("integration", velocitySolverEnd, integrationEnd);
+    PROFILE_RECORD("position solver", integrationEnd, positionSolverEnd);
+    PROFILE_RECORD("sleeping", positionSolverEnd, sleepingEnd);
+
+    timings.broadphase += broadphaseEnd - time;
+    timings.narrowphase += narrowphaseEnd - broadphaseEnd;
+    timings.islands += (islandsEnd - narrowphaseEnd) + (sleepingEnd - positionSolverEnd);
+    timings.velocitySolver += velocitySolverEnd - islandsEnd;
+    timings.integration += integrationEnd - velocitySolverEnd;
+    timings.positionSolver += positionSolverEnd - integrationEnd;
+}
@@ -2,80 +2,39 @@
 #define PHYSICSTEST_PHYSICS_H
 
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 #include <string>
+#include <vector>
+
+#include "Broadphase.h"
+#include "Checkpointer.h"
+#include "ContactCache.h"
+#include "ContactSolver.h"
+#include "ContinuousCollision.h"
+#include "Cube.h"
+#include "Islands.h"
+#include "JobSystem.h"
+#include "RenderState.h"
+#include "SceneSnapshot.h"
+#include "StateStorage.h"
+#include "World.h"
 
 using namespace glm;
 using namespace std;
 
-struct SerializedCube {
-    vec3 position;
-    mat3 rotation;
-};
-
-class Cube {
-private:
-    vec3 position;
-    mat3 rotation;
-    vec3 size;
-
-    vec3 points[8];
-
-    // physics
-    void calcPoints();
-public:
-    Cube(vec3 position, mat3 rotation, vec3 size);
-
-    const vec3 getPosition() const;
-    const mat3 getRotation() const;
-    const vec3 getSize() const;
-
-    static const unsigned int POINTS_COUNT = 8;
-    const vec3* getPoints() const;
-
-    const vec3 getLeftBottomNear() const;
-    const vec3 getRightTopFar() const;
-
-    void integrateTransforms(vec3 positionDelta, vec3 rotationDelta);
-
-    void loadFromState(SerializedCube state);
-    void saveToState(SerializedCube* state);
-};
-
-struct SerializedPhysics {
-    vec3 linearVelocity, angularVelocity;
-};
-
-class PhysicsData {
-private:
-    const float RESTITUTION = 0.0f;
-    const float FRICTION = 1.0f;
-
-    Cube *cube, *walls;
-
-    vec3 linearVelocity, angularVelocity;
-
-    float invMass;
-    mat3 localInvInertiaTensor, worldInvInertiaTensor;
-
-    void updateInertiaTensor();
-
-    void integrateTransforms(vec3 positionDelta, vec3 rotationDelta);
-public:
-    PhysicsData(Cube* cube, Cube* walls, float mass);
-
-    void applyGravity(vec3 gravity, double dt);
-
-    void applyPseudoImpulse(vec3 impulse, vec3 localPoint);
-    void applyImpulse(vec3 impulse, vec3 localPoint);
-
-    void processCollisions();
-    void integrate(double dt);
-
-    void applyDamping(double dt, float damping);
-
-    void loadFromState(SerializedPhysics state);
-    void saveToState(SerializedPhysics* state);
+// seconds spent in each stage of the last step, summed over its substeps
+struct PhysicsTimings {
+    double broadphase;
+    double narrowphase;
+    // island building and sleep updates
+    double islands;
+    double velocitySolver;
+    double integration;
+    double positionSolver;
+    double total;
+    // substeps the step was split into
+    unsigned int subStepCount;
 };
 
 class Physics {
@@ -86,6 +45,7 @@ public:
         return instance;
     }
 
+    // layout of state.bin before the versioned snapshot, only read to import old files
     struct SerializedScene {
         vec3 gravity;
         SerializedCube cubeState;
@@ -100,24 +60,133 @@ private:
     int initialized;
 
     vec3 gravity;
+    // gravity when the bodies were last woken, sleeping bodies ignore smaller changes than the threshold
+    vec3 restingGravity;
+    static constexpr float GRAVITY_WAKE_THRESHOLD = 0.5f;
+
+    World world;
+    Cube *walls;
+
+    BroadphaseType broadphaseType;
+    Broadphase* broadphase;
+    vector<Aabb> aabbs;
+    vector<BodyPair> pairs;
+    ContactCache contacts;
+    ContactSolver solver;
+    Islands islands;
+
+    // 0 for one per core
+    unsigned int threadCount;
+    JobSystem* jobs;
+
+    PhysicsTimings timings;
+
+    // bodies closer than this to a wall get a wall pair
+    static constexpr float WALL_PAIR_MARGIN = 0.05f;
 
-    Cube *cube, *walls;
-    PhysicsData *cubePhysics;
+    // a substep moves no body by more than this share of its smallest dimension
+    static constexpr float MAX_SUB_STEP_TRAVEL = 0.1f;
+    // penetration above this at the end of a step splits the next one, each multiple of it one substep more
+    static constexpr float SUB_STEP_PENETRATION = 0.05f;
+    static const unsigned int DEFAULT_MAX_SUB_STEPS = 4;
+
+    unsigned int maxSubSteps;
+    // deepest contact left by the last step
+    float lastPenetration;
+
+    ContinuousCollision ccd;
+    // set when the substeps of this step are not enough to keep the fastest body slow, otherwise the sweep is skipped
+    bool sweepFastBodies;
+
+    // travel is the largest relative travel of a body over the whole step
+    unsigned int chooseSubStepCount(float travel);
+    float findMaxPenetration();
+
+    Aabb getWallsBounds();
+    void updateBroadphase();
+    void findWallPairs();
 
     void subStep(double dt);
 
+    // nullptr keeps nothing between runs
+    StateStorage* storage;
     const string STATE_FILE_NAME = "state.bin";
+    // where an unreadable state file goes, so it can be looked at later
+    const string BAD_STATE_FILE_NAME = "state.bin.bad";
+
+    // writes the periodic checkpoints of the state file
+    Checkpointer checkpointer;
+    // the last initialize found a state file it could read
+    bool stateRestored;
 
     void loadSimulationState();
     void saveSimulationState();
+    void importLegacyState(const SerializedScene& scene);
 public:
+    // set before initialize, the state is loaded on initialize and saved on finalize
+    void setStorage(StateStorage* storage);
+    // copies the state for the checkpoint thread, which replaces the state file with it in the background,
+    // false if the previous checkpoints are still being written or there is no storage
+    bool checkpoint();
+    // the world came from the state file rather than the default scene
+    bool isStateRestored();
+
     void initialize();
     void finalize();
 
-    const Cube* getCube();
+    BodyHandle addCube(vec3 position, quat orientation, vec3 size, float mass);
+    void removeBody(BodyHandle handle);
+
+    // fills the walls with a lattice of equal boxes in place of every body there was, used for load testing
+    void spawnCubes(unsigned int count, float mass);
+
+    void setBroadphase(BroadphaseType type);
+
+    // candidate pairs found by the broadphase in the last substep
+    const vector<BodyPair>& getPairs();
+    // touching pairs found by the narrowphase in the last substep
+    const vector<ContactManifold>& getManifolds();
+
+    // more iterations give stiffer stacks and less penetration for more time per step
+    void setVelocityIterations(unsigned int iterations);
+    unsigned int getVelocityIterations();
+    void setPositionIterations(unsigned int iterations);
+    unsigned int getPositionIterations();
+
+    // upper bound of the substeps a step is split into, fast bodies and deep penetrations take more of them
+    void setMaxSubSteps(unsigned int count);
+    unsigned int getMaxSubSteps();
+
+    // threads the islands are solved on, 0 for one per core
+    void setThreadCount(unsigned int count);
+    unsigned int getThreadCount();
+
+    const PhysicsTimings& getTimings();
+
+    // the bodies, their contacts, the gravity and the solver settings, see SceneSnapshot.h
+    void saveSnapshot(vector<unsigned char>& snapshot);
+    // false and nothing changed if the data isn't a snapshot this build can read
+    bool loadSnapshot(const unsigned char* snapshot, size_t size);
+
+    // equal for two runs only while they are bit for bit in the same state, cheap enough to take every step
+    uint64_t calcStateHash();
+
+    // built with PHYSICS_DETERMINISTIC, state hashes then match between platforms, not only between runs of one binary
+    static constexpr bool isDeterministic() {
+#ifdef PHYSICSTEST_DETERMINISTIC
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    const World& getWorld();
+    // copies what the renderer needs out of the world, called after every step
+    void saveRenderState(RenderState& state);
     const Cube* getWalls();
 
     vec3 getGravity();
+    // wakes every body once the gravity has moved far enough from where they came to rest
     void setGravity(vec3 gravity);
 
     void step(double dt);
@@ -0,0 +1,199 @@
+#include "PhysicsThread.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "assertUtils.h"
+
+#include "Physics.h"
+#include "Profiler.h"
+
+extern "C" {
+#include "generalUtils.h"
+}
+
+constexpr double PhysicsThread::STEP_TIME;
+const unsigned int PhysicsThread::MAX_CATCH_UP_STEPS;
+const unsigned int PhysicsThread::CHECKPOINT_STEPS;
+
+PhysicsThread::PhysicsThread() : running(false), gravityQueue(16), nextStepTime(0), stepCount(0), stats(nullptr), recorder(nullptr),
+                                 completedSteps(0), droppedSteps(0) {
+
+}
+
+void PhysicsThread::start() {
+
+    if (this->running)
+        return;
+
+    // nothing runs the physics yet, so the first snapshot can be written from here
+    Physics& physics = Physics::getInstance();
+    physics.saveRenderState(this->lastState);
+    this->gravity = physics.getGravity();
+
+    if (this->recorder != nullptr) {
+        vector<unsigned char> snapshot;
+        physics.saveSnapshot(snapshot);
+        this->recorder->start(snapshot, STEP_TIME);
+    }
+
+    double now = getTime();
+
+    this->stepCount = 0;
+    this->nextStepTime = now + STEP_TIME;
+    this->completedSteps = 0;
+    this->droppedSteps = 0;
+
+    publish(now);
+
+    this->running = true;
+    pthread_check_error(pthread_create(&thread, nullptr, thread_entrypoint, this));
+}
+
+void PhysicsThread::stop() {
+
+    if (!this->running)
+        return;
+
+    this->running = false;
+    pthread_check_error(pthread_join(thread, nullptr));
+
+    if (this->recorder != nullptr)
+        this->recorder->stop();
+}
+
+bool PhysicsThread::isRunning() {
+    return this->running;
+}
+
+void PhysicsThread::setFrameStats(FrameStats* stats) {
+
+    my_assert(!this->running);
+    this->stats = stats;
+}
+
+void PhysicsThread::setRecorder(ReplayRecorder* recorder) {
+
+    my_assert(!this->running);
+    this->recorder = recorder;
+}
+
+void PhysicsThread::setGravity(vec3 gravity) {
+    // a full queue means the physics thread is behind, the gravity of the next frame will do
+    this->gravityQueue.try_enqueue(gravity);
+}
+
+bool PhysicsThread::updateSnapshot() {
+    return this->snapshots.update();
+}
+
+const PhysicsSnapshot& PhysicsThread::getSnapshot() {
+    return this->snapshots.getFront();
+}
+
+float PhysicsThread::getAlpha(double time) {
+
+    // drawn a step behind, the current state is the one that is due at the snapshot time
+    double alpha = (time - getSnapshot().time) / STEP_TIME;
+
+    return (float) std::min(std::max(alpha, 0.0), 1.0);
+}
+
+unsigned int PhysicsThread::getCompletedSteps() {
+    return this->completedSteps;
+}
+
+unsigned int PhysicsThread::getDroppedSteps() {
+    return this->droppedSteps;
+}
+
+// thread
+
+void* PhysicsThread::thread_entrypoint(void* opaque) {
+
+    ((PhysicsThread*)opaque)->threadLoop();
+    return nullptr;
+}
+
+void PhysicsThread::receiveGravity() {
+
+    // only the newest one matters
+    vec3 gravity;
+    while (this->gravityQueue.try_dequeue(gravity))
+        this->gravity = gravity;
+}
+
+void PhysicsThread::publish(double time) {
+
+    PhysicsSnapshot& snapshot = this->snapshots.getBack();
+
+    swap(snapshot.previous, this->lastState);
+    Physics::getInstance().saveRenderState(snapshot.current);
+    this->lastState = snapshot.current;
+
+    // the first snapshot has nothing before it
+    if (this->stepCount == 0)
+        snapshot.previous = snapshot.current;
+
+    snapshot.time = time;
+    snapshot.step = this->stepCount;
+
+    this->snapshots.publish();
+}
+
+void PhysicsThread::threadLoop() {
+
+    PROFILE_THREAD_NAME("physics");
+
+    while (this->running) {
+
+        double now = getTime();
+        if (now < this->nextStepTime) {
+            usleep((useconds_t) timeToUSec(this->nextStepTime - now));
+            continue;
+        }
+
+        receiveGravity();
+
+        unsigned int steps = 0;
+        while (now >= this->nextStepTime && steps < MAX_CATCH_UP_STEPS) {
+
+            Physics& physics = Physics::getInstance();
+
+            // set every step, so a replay can set the same values at the same steps
+            physics.setGravity(this->recorder != nullptr ? this->recorder->recordStep(this->gravity) : this->gravity);
+            physics.step(STEP_TIME);
+
+            if (this->recorder != nullptr && this->recorder->needsHash())
+                this->recorder->recordHash(physics.calcStateHash());
+
+            if (this->recorder != nullptr && this->recorder->needsRestart()) {
+                vector<unsigned char> snapshot;
+                physics.saveSnapshot(snapshot);
+                this->recorder->start(snapshot, STEP_TIME);
+            }
+
+            if (this->stats != nullptr)
+                this->stats->addPhysicsStep(physics.getTimings().total);
+
+            this->stepCount++;
+            publish(this->nextStepTime);
+
+            // skipped by the physics if the storage is still busy with the last ones
+            if (this->stepCount % CHECKPOINT_STEPS == 0)
+                Physics::getInstance().checkpoint();
+
+            this->nextStepTime += STEP_TIME;
+            steps++;
+        }
+
+        this->completedSteps += steps;
+
+        if (now >= this->nextStepTime) {
+            unsigned int behind = (unsigned int)((now - this->nextStepTime) / STEP_TIME) + 1;
+            this->droppedSteps += behind;
+            this->nextStepTime += behind * STEP_TIME;
+        }
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef PHYSICSTEST_PHYSICS_THREAD_H
+#define PHYSICSTEST_PHYSICS_THREAD_H
+
+#include <pthread.h>
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+
+#include "readerwriterqueue.h"
+
+#include "FrameStats.h"
+#include "RenderState.h"
+#include "Replay.h"
+#include "TripleBuffer.h"
+
+using namespace glm;
+using namespace moodycamel;
+using namespace std;
+
+// the two states around the newest step, the renderer draws between them
+struct PhysicsSnapshot {
+    RenderState previous, current;
+    // real time the current state belongs to
+    double time;
+    unsigned int step;
+};
+
+// steps the physics at a fixed rate on its own thread, so vsync and gpu stalls of the renderer don't hold it back
+// the renderer gets immutable snapshots through a triple buffer and hands the gravity over through a queue
+class PhysicsThread {
+public:
+    static PhysicsThread& getInstance() {
+        static PhysicsThread instance;
+
+        return instance;
+    }
+
+    PhysicsThread(PhysicsThread const&) = delete;
+    void operator=(PhysicsThread const&) = delete;
+
+    // the physics always steps by this, whatever the display runs at
+    static constexpr double STEP_TIME = 1.0 / 60.0;
+    // steps taken at most in one go to catch up, lag beyond that is dropped so a stall doesn't snowball
+    static const unsigned int MAX_CATCH_UP_STEPS = 4;
+    // the state is checkpointed every this many steps, 5 seconds
+    static const unsigned int CHECKPOINT_STEPS = 300;
+private:
+    PhysicsThread();
+
+    pthread_t thread;
+    std::atomic<bool> running;
+
+    ReaderWriterQueue<vec3> gravityQueue;
+    TripleBuffer<PhysicsSnapshot> snapshots;
+
+    // written by the physics thread only
+    double nextStepTime;
+    unsigned int stepCount;
+    RenderState lastState;
+    // newest gravity from the renderer, applied at the start of every step
+    vec3 gravity;
+    FrameStats* stats;
+    ReplayRecorder* recorder;
+
+    std::atomic<unsigned int> completedSteps;
+    std::atomic<unsigned int> droppedSteps;
+
+    void receiveGravity();
+    void publish(double time);
+
+    static void* thread_entrypoint(void* opaque);
+    void threadLoop();
+public:
+    // the physics has to be initialized and must not be touched by anyone else until stop
+    void start();
+    void stop();
+    bool isRunning();
+
+    // the time of every step goes there, nullptr for none, set while stopped
+    void setFrameStats(FrameStats* stats);
+
+    // records every run from start to stop, nullptr for none, set while stopped
+    void setRecorder(ReplayRecorder* recorder);
+
+    // from one thread only, the renderer's
+    void setGravity(vec3 gravity);
+
+    // from one thread only, the renderer's, false if no step was published since the last call
+    bool updateSnapshot();
+    const PhysicsSnapshot& getSnapshot();
+    // how far the given real time is between the snapshot's states, clamped to [0, 1]
+    float getAlpha(double time);
+
+    // steps taken and steps dropped by the catch up limit since start, readable from any thread
+    unsigned int getCompletedSteps();
+    unsigned int getDroppedSteps();
+};
+
+#endif //PHYSICSTEST_PHYSICS_THREAD_H
@@ -0,0 +1,161 @@
+#include "Profiler.h"
+
+#include <stdio.h>
+
+#include "assertUtils.h"
+
+extern "C" {
+#include "generalUtils.h"
+}
+
+const unsigned int Profiler::RING_SIZE;
+
+Profiler::Profiler() : startTime(getTime()) {
+    pthread_check_error(pthread_mutex_init(&mutex, nullptr));
+}
+
+Profiler::~Profiler() {
+
+    for (ThreadBuffer* buffer : buffers)
+        delete buffer;
+
+    pthread_check_error(pthread_mutex_destroy(&mutex));
+}
+
+Profiler::ThreadBufferOwner::~ThreadBufferOwner() {
+
+    if (buffer != nullptr)
+        Profiler::getInstance().retireThreadBuffer(buffer);
+
+    buffer = nullptr;
+}
+
+Profiler::ThreadBuffer* Profiler::getThreadBuffer() {
+
+    static thread_local ThreadBufferOwner owner;
+
+    if (owner.buffer == nullptr) {
+
+        pthread_check_error(pthread_mutex_lock(&mutex));
+
+        ThreadBuffer* buffer;
+
+        // a retired ring keeps its lane, but starts over under the new thread
+        if (!retiredBuffers.empty()) {
+            buffer = retiredBuffers.back();
+            retiredBuffers.pop_back();
+            buffer->threadName.clear();
+        } else {
+            buffer = new ThreadBuffer();
+            buffer->zones.resize(RING_SIZE);
+            buffer->threadIndex = (unsigned int) buffers.size();
+            buffers.push_back(buffer);
+        }
+
+        buffer->written.store(0, memory_order_relaxed);
+        buffer->retired = false;
+
+        pthread_check_error(pthread_mutex_unlock(&mutex));
+
+        owner.buffer = buffer;
+    }
+
+    return owner.buffer;
+}
+
+void Profiler::retireThreadBuffer(ThreadBuffer* buffer) {
+
+    pthread_check_error(pthread_mutex_lock(&mutex));
+    buffer->retired = true;
+    retiredBuffers.push_back(buffer);
+    pthread_check_error(pthread_mutex_unlock(&mutex));
+}
+
+void Profiler::setThreadName(const string& name) {
+
+    ThreadBuffer* buffer = getThreadBuffer();
+
+    pthread_check_error(pthread_mutex_lock(&mutex));
+    buffer->threadName = name;
+    pthread_check_error(pthread_mutex_unlock(&mutex));
+}
+
+void Profiler::record(const char* name, double start, double end) {
+
+    ThreadBuffer* buffer = getThreadBuffer();
+
+    unsigned long long written = buffer->written.load(memory_order_relaxed);
+
+    Zone& zone = buffer->zones[written % RING_SIZE];
+    zone.name = name;
+    zone.start = start;
+    zone.end = end;
+
+    // publishes the zone to the exporting thread
+    buffer->written.store(written + 1, memory_order_release);
+}
+
+string Profiler::exportChromeTrace() {
+
+    string trace = "{\"traceEvents\":[\n";
+    bool first = true;
+
+    char event[256];
+
+    pthread_check_error(pthread_mutex_lock(&mutex));
+
+    for (const ThreadBuffer* buffer : buffers) {
+
+        unsigned long long written = buffer->written.load(memory_order_acquire);
+
+        // an exited thread with nothing left to show
+        if (buffer->retired && written == 0)
+            continue;
+
+        string threadName = buffer->threadName.empty() ? "thread " + to_string(buffer->threadIndex) :
+                                                         buffer->threadName;
+
+        snprintf(event, sizeof(event),
+                 "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                 first ? "" : ",\n", buffer->threadIndex, threadName.c_str());
+        trace += event;
+        first = false;
+
+        unsigned long long begin = written > RING_SIZE ? written - RING_SIZE : 0;
+
+        for (unsigned long long index = begin; index < written; index++) {
+
+            const Zone& zone = buffer->zones[index % RING_SIZE];
+
+            // microseconds since the profiler was created
+            snprintf(event, sizeof(event),
+                     ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                     zone.name, buffer->threadIndex, (zone.start - startTime) * 1e6, (zone.end - zone.start) * 1e6);
+            trace += event;
+        }
+    }
+
+    pthread_check_error(pthread_mutex_unlock(&mutex));
+
+    trace += "\n]}\n";
+
+    return trace;
+}
+
+void Profiler::clear() {
+
+    pthread_check_error(pthread_mutex_lock(&mutex));
+
+    for (ThreadBuffer* buffer : buffers)
+        buffer->written.store(0, memory_order_release);
+
+    pthread_check_error(pthread_mutex_unlock(&mutex));
+}
+
+ProfileZone::ProfileZone(const char* name) : name(name), start(getTime()) {
+
+}
+
+ProfileZone::~ProfileZone() {
+    Profiler::getInstance().record(name, start, getTime());
+}
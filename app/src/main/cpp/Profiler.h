@@ -0,0 +1,115 @@
+#ifndef PHYSICSTEST_PROFILER_H
+#define PHYSICSTEST_PROFILER_H
+
+#include <pthread.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// timing zones of the hot paths, exported as a chrome trace (chrome://tracing, perfetto) with a lane per thread
+// every thread records into its own ring buffer, so recording takes no locks; only a thread's first zone registers it
+// a thread's ring is retired when the thread exits and handed to the next new thread, which starts it over,
+// so the rings never outnumber the threads alive at once; the zones of a retired ring stay in the trace until then
+// the zones compile to nothing unless PHYSICSTEST_PROFILING is defined, the PHYSICS_PROFILING cmake option
+class Profiler {
+public:
+    static Profiler& getInstance() {
+        static Profiler instance;
+
+        return instance;
+    }
+
+    Profiler(Profiler const&) = delete;
+    void operator=(Profiler const&) = delete;
+
+    // zones kept per thread, older ones are overwritten
+    static const unsigned int RING_SIZE = 1 << 16;
+private:
+    Profiler();
+
+    struct Zone {
+        // a string literal, only the pointer is kept
+        const char* name;
+        double start, end;
+    };
+
+    struct ThreadBuffer {
+        unsigned int threadIndex;
+        string threadName;
+
+        vector<Zone> zones;
+        // zones ever recorded, the newest one is at (written - 1) % RING_SIZE
+        atomic<unsigned long long> written;
+        // its thread has exited
+        bool retired;
+    };
+
+    // retires the thread's buffer when the thread exits
+    struct ThreadBufferOwner {
+        ThreadBuffer* buffer = nullptr;
+
+        ~ThreadBufferOwner();
+    };
+
+    pthread_mutex_t mutex;
+    vector<ThreadBuffer*> buffers;
+    // waiting for the next new thread
+    vector<ThreadBuffer*> retiredBuffers;
+
+    double startTime;
+
+    ThreadBuffer* getThreadBuffer();
+    void retireThreadBuffer(ThreadBuffer* buffer);
+public:
+    ~Profiler();
+
+    static constexpr bool isEnabled() {
+#ifdef PHYSICSTEST_PROFILING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // shown as the lane title, "thread N" otherwise
+    void setThreadName(const string& name);
+
+    void record(const char* name, double start, double end);
+
+    // every zone still in the rings, the trace is best read while the recording threads are idle
+    string exportChromeTrace();
+    // drops everything recorded so far, the lanes of exited threads with it, while the recording threads are idle
+    void clear();
+};
+
+// times the rest of the enclosing scope
+class ProfileZone {
+private:
+    const char* name;
+    double start;
+public:
+    explicit ProfileZone(const char* name);
+    ~ProfileZone();
+
+    ProfileZone(ProfileZone const&) = delete;
+    void operator=(ProfileZone const&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef PHYSICSTEST_PROFILING
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+// for stages that are timed already, start and end come from getTime
+#define PROFILE_RECORD(name, start, end) Profiler::getInstance().record(name, start, end)
+#define PROFILE_THREAD_NAME(name) Profiler::getInstance().setThreadName(name)
+#else
+#define PROFILE_ZONE(name)
+#define PROFILE_RECORD(name, start, end)
+#define PROFILE_THREAD_NAME(name)
+#endif
+
+#endif //PHYSICSTEST_PROFILER_H
@@ -7,6 +7,7 @@
 #include "exceptionUtils.h"
 
 #include "AssetManager.h"
+#include "Profiler.h"
 
 #define RENDER_TAG "PT_RENDER"
 
@@ -418,28 +419,38 @@ void Render::drawLine(vec3 origin, vec3 delta, GLuint tex, GLenum cullMode) {
     drawCube(origin + delta * 0.5f, rotation, size, tex, cullMode);
 }
 
-void Render::draw() {
+void Render::draw(const RenderState& state) {
+
+    PROFILE_ZONE("Render::draw");
 
     if (this->window == nullptr)
         return;
 
-    // cameraPosition.z = Physics::getInstance().getCube()->getPosition().z;
-    lookAtPoint(Physics::getInstance().getCube()->getPosition());
+    // cameraPosition.z = state.positions[0].z;
+    if (!state.positions.empty())
+        lookAtPoint(state.positions[0]);
+    else
+        lookAtPoint(Physics::getInstance().getWalls()->getPosition());
 
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     drawCube(Physics::getInstance().getWalls(), wallTexture, GL_FRONT);
 
-    drawCube(Physics::getInstance().getCube(), cubeTexture, GL_BACK);
+    for (unsigned int index = 0; index < state.positions.size(); index++)
+        drawCube(state.positions[index], mat3_cast(state.orientations[index]), state.sizes[index], cubeTexture, GL_BACK);
 
     /*
-    drawLine(Physics::getInstance().getCube()->getPosition(), Physics::getInstance().getGravity() * 0.1f,
+    drawLine(state.positions[0], state.gravity * 0.1f,
             cubeTexture, GL_BACK);
     */
 
     // glFlush(); // do we need this or what?
 
-    eglSwapBuffers(display, surface);
+    {
+        // waits for vsync and for the gpu to catch up
+        PROFILE_ZONE("eglSwapBuffers");
+        eglSwapBuffers(display, surface);
+    }
 }
 
 float Render::getCameraXAngle() {
@@ -12,6 +12,7 @@
 #include <glm/glm.hpp>
 
 #include "Physics.h"
+#include "RenderState.h"
 
 using namespace std;
 using namespace glm;
@@ -75,7 +76,8 @@ public:
     float getCameraXAngle();
     float getCameraZAngle();
 
-    void draw();
+    // the walls come from the physics, the bodies from the state
+    void draw(const RenderState& state);
 };
 
 #endif //PHYSICSTEST_RENDER_H
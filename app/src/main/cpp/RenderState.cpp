@@ -0,0 +1,22 @@
+#include "RenderState.h"
+
+void interpolateRenderStates(const RenderState& previous, const RenderState& current, float alpha,
+                             RenderState& result) {
+
+    result.positions.resize(current.positions.size());
+    result.orientations.resize(current.orientations.size());
+    result.sizes.assign(current.sizes.begin(), current.sizes.end());
+
+    result.gravity = mix(previous.gravity, current.gravity, alpha);
+
+    if (previous.positions.size() != current.positions.size()) {
+        result.positions.assign(current.positions.begin(), current.positions.end());
+        result.orientations.assign(current.orientations.begin(), current.orientations.end());
+        return;
+    }
+
+    for (unsigned int index = 0; index < current.positions.size(); index++) {
+        result.positions[index] = mix(previous.positions[index], current.positions[index], alpha);
+        result.orientations[index] = slerp(previous.orientations[index], current.orientations[index], alpha);
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef PHYSICSTEST_RENDER_STATE_H
+#define PHYSICSTEST_RENDER_STATE_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <vector>
+
+using namespace glm;
+using namespace std;
+
+// body transforms at the end of one physics step, the renderer draws between the last two of them
+struct RenderState {
+    vector<vec3> positions;
+    vector<quat> orientations;
+    vector<vec3> sizes;
+
+    vec3 gravity;
+};
+
+// alpha of the way from previous to current, bodies added or removed in between snap to current
+void interpolateRenderStates(const RenderState& previous, const RenderState& current, float alpha,
+                             RenderState& result);
+
+#endif //PHYSICSTEST_RENDER_STATE_H
@@ -0,0 +1,292 @@
+#include "Replay.h"
+
+#include <math.h>
+#include <string.h>
+
+// magic, version, header size, snapshot size, stream size, step count, step time, gravity quantum,
+// and since version 2 hash interval and flags
+static const unsigned int HEADER_WORDS = 10;
+static const unsigned int HEADER_SIZE = HEADER_WORDS * 4;
+static const unsigned int VERSION_1_HEADER_SIZE = 8 * 4;
+
+static void putWord(vector<unsigned char>& data, uint32_t word) {
+
+    for (unsigned int byte = 0; byte < 4; byte++)
+        data.push_back((unsigned char)(word >> (byte * 8)));
+}
+
+static uint32_t getWord(const unsigned char* data) {
+    return (uint32_t) data[0] | ((uint32_t) data[1] << 8) | ((uint32_t) data[2] << 16) | ((uint32_t) data[3] << 24);
+}
+
+static uint32_t floatToWord(float value) {
+
+    uint32_t word;
+    memcpy(&word, &value, sizeof(word));
+
+    return word;
+}
+
+static float wordToFloat(uint32_t word) {
+
+    float value;
+    memcpy(&value, &word, sizeof(value));
+
+    return value;
+}
+
+static void putVarint(vector<unsigned char>& data, int value) {
+
+    // zigzag, small negative changes stay small
+    uint32_t bits = ((uint32_t) value << 1) ^ (uint32_t)(value >> 31);
+
+    while (bits >= 0x80) {
+        data.push_back((unsigned char)(bits | 0x80));
+        bits >>= 7;
+    }
+    data.push_back((unsigned char) bits);
+}
+
+static bool getVarint(const unsigned char*& position, const unsigned char* end, int& value) {
+
+    uint32_t bits = 0;
+    for (unsigned int shift = 0; shift < 35; shift += 7) {
+
+        if (position == end)
+            return false;
+
+        unsigned char byte = *position++;
+        bits |= (uint32_t)(byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0) {
+            value = (int)(bits >> 1) ^ -(int)(bits & 1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// recorder
+
+ReplayRecorder::ReplayRecorder() : recording(false), stepCount(0), stepTime(0), hashInterval(DEFAULT_HASH_INTERVAL),
+                                   maxStreamSize(DEFAULT_MAX_STREAM_SIZE), lastGravity() {
+
+}
+
+void ReplayRecorder::setHashInterval(unsigned int interval) {
+    this->hashInterval = interval;
+}
+
+void ReplayRecorder::setMaxStreamSize(unsigned int size) {
+    this->maxStreamSize = size;
+}
+
+void ReplayRecorder::start(const vector<unsigned char>& snapshot, float stepTime) {
+
+    this->snapshot = snapshot;
+    this->stream.clear();
+    this->stepCount = 0;
+    this->stepTime = stepTime;
+
+    for (unsigned int axis = 0; axis < 3; axis++)
+        this->lastGravity[axis] = 0;
+
+    this->recording = true;
+}
+
+void ReplayRecorder::stop() {
+    this->recording = false;
+}
+
+bool ReplayRecorder::isRecording() const {
+    return this->recording;
+}
+
+vec3 ReplayRecorder::recordStep(vec3 gravity) {
+
+    int quantized[3];
+    for (unsigned int axis = 0; axis < 3; axis++)
+        quantized[axis] = (int) lroundf(gravity[axis] / GRAVITY_QUANTUM);
+
+    if (this->recording) {
+
+        unsigned char changed = 0;
+        for (unsigned int axis = 0; axis < 3; axis++)
+            if (quantized[axis] != this->lastGravity[axis])
+                changed |= 1 << axis;
+
+        this->stream.push_back(changed);
+        for (unsigned int axis = 0; axis < 3; axis++)
+            if (changed & (1 << axis))
+                putVarint(this->stream, quantized[axis] - this->lastGravity[axis]);
+
+        for (unsigned int axis = 0; axis < 3; axis++)
+            this->lastGravity[axis] = quantized[axis];
+
+        this->stepCount++;
+    }
+
+    return vec3(quantized[0], quantized[1], quantized[2]) * GRAVITY_QUANTUM;
+}
+
+bool ReplayRecorder::needsHash() const {
+    return this->recording && this->hashInterval > 0 && this->stepCount % this->hashInterval == 0;
+}
+
+void ReplayRecorder::recordHash(uint64_t hash) {
+
+    putWord(this->stream, (uint32_t) hash);
+    putWord(this->stream, (uint32_t)(hash >> 32));
+}
+
+bool ReplayRecorder::needsRestart() const {
+    return this->recording && this->maxStreamSize > 0 && this->stream.size() >= this->maxStreamSize;
+}
+
+unsigned int ReplayRecorder::getStepCount() const {
+    return this->stepCount;
+}
+
+void ReplayRecorder::save(vector<unsigned char>& recording) const {
+
+    recording.clear();
+    recording.reserve(HEADER_SIZE + this->snapshot.size() + this->stream.size());
+
+    putWord(recording, REPLAY_MAGIC);
+    putWord(recording, REPLAY_VERSION);
+    putWord(recording, HEADER_SIZE);
+    putWord(recording, (uint32_t) this->snapshot.size());
+    putWord(recording, (uint32_t) this->stream.size());
+    putWord(recording, this->stepCount);
+    putWord(recording, floatToWord(this->stepTime));
+    putWord(recording, floatToWord(GRAVITY_QUANTUM));
+    putWord(recording, this->hashInterval);
+#ifdef PHYSICSTEST_DETERMINISTIC
+    putWord(recording, REPLAY_DETERMINISTIC);
+#else
+    putWord(recording, 0);
+#endif
+
+    recording.insert(recording.end(), this->snapshot.begin(), this->snapshot.end());
+    recording.insert(recording.end(), this->stream.begin(), this->stream.end());
+}
+
+// player
+
+ReplayPlayer::ReplayPlayer() : snapshot(nullptr), snapshotSize(0), stream(nullptr), streamEnd(nullptr),
+                               position(nullptr), stepCount(0), step(0), stepTime(0), hashInterval(0),
+                               flags(0), gravity(), hasStepHash(false), stepHash(0) {
+
+}
+
+bool ReplayPlayer::open(const unsigned char* recording, size_t size) {
+
+    if (size < VERSION_1_HEADER_SIZE || getWord(recording) != REPLAY_MAGIC)
+        return false;
+
+    uint32_t version = getWord(recording + 4);
+    uint32_t headerSize = getWord(recording + 8);
+    if (version < 1 || version > REPLAY_VERSION || headerSize != (version == 1 ? VERSION_1_HEADER_SIZE : HEADER_SIZE))
+        return false;
+
+    uint32_t snapshotSize = getWord(recording + 12);
+    uint32_t streamSize = getWord(recording + 16);
+
+    // a different quantum would give different gravity values than the recorded run saw
+    if (wordToFloat(getWord(recording + 28)) != GRAVITY_QUANTUM ||
+        (uint64_t) headerSize + snapshotSize + streamSize > size)
+        return false;
+
+    this->snapshot = recording + headerSize;
+    this->snapshotSize = snapshotSize;
+    this->stream = this->snapshot + snapshotSize;
+    this->streamEnd = this->stream + streamSize;
+    this->stepCount = getWord(recording + 20);
+    this->stepTime = wordToFloat(getWord(recording + 24));
+    this->hashInterval = version >= 2 ? getWord(recording + 32) : 0;
+    this->flags = version >= 2 ? getWord(recording + 36) : 0;
+
+    rewind();
+
+    return true;
+}
+
+void ReplayPlayer::rewind() {
+
+    this->position = this->stream;
+    this->step = 0;
+    this->hasStepHash = false;
+
+    for (unsigned int axis = 0; axis < 3; axis++)
+        this->gravity[axis] = 0;
+}
+
+const unsigned char* ReplayPlayer::getSnapshot() const {
+    return this->snapshot;
+}
+
+size_t ReplayPlayer::getSnapshotSize() const {
+    return this->snapshotSize;
+}
+
+unsigned int ReplayPlayer::getStepCount() const {
+    return this->stepCount;
+}
+
+float ReplayPlayer::getStepTime() const {
+    return this->stepTime;
+}
+
+unsigned int ReplayPlayer::getHashInterval() const {
+    return this->hashInterval;
+}
+
+bool ReplayPlayer::isDeterministic() const {
+    return (this->flags & REPLAY_DETERMINISTIC) != 0;
+}
+
+bool ReplayPlayer::nextStep(vec3& gravity) {
+
+    if (this->step >= this->stepCount || this->position == this->streamEnd)
+        return false;
+
+    unsigned char changed = *this->position++;
+
+    for (unsigned int axis = 0; axis < 3; axis++) {
+
+        if ((changed & (1 << axis)) == 0)
+            continue;
+
+        int delta;
+        if (!getVarint(this->position, this->streamEnd, delta))
+            return false;
+
+        this->gravity[axis] += delta;
+    }
+
+    this->step++;
+
+    this->hasStepHash = this->hashInterval > 0 && this->step % this->hashInterval == 0;
+    if (this->hasStepHash) {
+
+        if (this->streamEnd - this->position < 8)
+            return false;
+
+        this->stepHash = (uint64_t) getWord(this->position) | ((uint64_t) getWord(this->position + 4) << 32);
+        this->position += 8;
+    }
+
+    gravity = vec3(this->gravity[0], this->gravity[1], this->gravity[2]) * GRAVITY_QUANTUM;
+
+    return true;
+}
+
+bool ReplayPlayer::getStepHash(uint64_t& hash) const {
+
+    if (!this->hasStepHash)
+        return false;
+
+    hash = this->stepHash;
+    return true;
+}
@@ -0,0 +1,116 @@
+#ifndef PHYSICSTEST_REPLAY_H
+#define PHYSICSTEST_REPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+using namespace glm;
+using namespace std;
+
+// a recording is everything needed to step the simulation again exactly as it ran:
+// the snapshot it started from and the gravity of every step, the only input the physics takes
+//
+//   header | snapshot, see SceneSnapshot.h | gravity stream
+//
+// the header is little endian 32 bit words, the stream has one entry per step: a byte with a bit for every axis
+// whose gravity changed, then the change of those axes in quanta as zigzag varints, so a steady step takes one byte,
+// then every hash interval steps the state hash after the step as a little endian 64 bit word
+// the gravity is quantized before the live physics sees it, so a replay gets bit for bit the same values
+
+static const uint32_t REPLAY_MAGIC = 0x50525450; // "PTRP"
+// version 1 had no hashes and no flags
+static const uint32_t REPLAY_VERSION = 2;
+// recorded by a deterministic build, its hashes hold on any platform running one
+static const uint32_t REPLAY_DETERMINISTIC = 1;
+// a hash every step only pays off where the hashes hold across platforms, elsewhere one a second at 60 steps
+// a second is enough to tell when a replay went off
+#ifdef PHYSICSTEST_DETERMINISTIC
+static const unsigned int DEFAULT_HASH_INTERVAL = 1;
+#else
+static const unsigned int DEFAULT_HASH_INTERVAL = 60;
+#endif
+// past this the recording starts over from a fresh snapshot, so a long session keeps only its last stretch
+static const unsigned int DEFAULT_MAX_STREAM_SIZE = 1 << 20;
+// smallest gravity change a recording keeps, in m/s^2
+static constexpr float GRAVITY_QUANTUM = 1.0f / 1024.0f;
+
+class ReplayRecorder {
+private:
+    bool recording;
+
+    vector<unsigned char> snapshot;
+    vector<unsigned char> stream;
+    unsigned int stepCount;
+    float stepTime;
+    unsigned int hashInterval;
+    unsigned int maxStreamSize;
+
+    int lastGravity[3];
+public:
+    ReplayRecorder();
+
+    // steps between state hashes, 0 for none, set before start
+    void setHashInterval(unsigned int interval);
+    // stream bytes after which needsRestart, 0 for no limit
+    void setMaxStreamSize(unsigned int size);
+
+    // snapshot is the state the recording starts from, taken right before the first recorded step
+    void start(const vector<unsigned char>& snapshot, float stepTime);
+    void stop();
+    bool isRecording() const;
+
+    // returns the quantized gravity, which is what the step has to use for the replay to match
+    vec3 recordStep(vec3 gravity);
+    // true when the state after the step just recorded has to be hashed and handed to recordHash
+    bool needsHash() const;
+    void recordHash(uint64_t hash);
+    // true once the stream is past its limit, start again with a snapshot of the state after the last step
+    bool needsRestart() const;
+
+    unsigned int getStepCount() const;
+    // the whole recording as a file
+    void save(vector<unsigned char>& recording) const;
+};
+
+class ReplayPlayer {
+private:
+    const unsigned char* snapshot;
+    uint32_t snapshotSize;
+    const unsigned char* stream;
+    const unsigned char* streamEnd;
+    const unsigned char* position;
+
+    unsigned int stepCount, step;
+    float stepTime;
+    unsigned int hashInterval;
+    uint32_t flags;
+
+    int gravity[3];
+    bool hasStepHash;
+    uint64_t stepHash;
+public:
+    ReplayPlayer();
+
+    // the recording is used in place and has to outlive the player, false if it isn't one this build can read
+    bool open(const unsigned char* recording, size_t size);
+    // back to the first step
+    void rewind();
+
+    const unsigned char* getSnapshot() const;
+    size_t getSnapshotSize() const;
+    unsigned int getStepCount() const;
+    float getStepTime() const;
+    unsigned int getHashInterval() const;
+    bool isDeterministic() const;
+
+    // the gravity of the next step, false once all steps have been played or the stream is corrupt
+    bool nextStep(vec3& gravity);
+    // the recorded hash of the state after the step nextStep returned, false if that step has none
+    bool getStepHash(uint64_t& hash) const;
+};
+
+#endif //PHYSICSTEST_REPLAY_H
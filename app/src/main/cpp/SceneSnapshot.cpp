@@ -0,0 +1,134 @@
+#include "SceneSnapshot.h"
+
+#include <string.h>
+
+#include "assertUtils.h"
+
+// offsets and sizes in 64 bits, so counts read from a corrupt header can't wrap around into a small layout
+struct SnapshotLayout {
+    uint64_t floatArrayStride;
+    uint64_t floatArraysOffset, awakeOffset, manifoldsOffset;
+    uint64_t fileSize;
+};
+
+static uint64_t alignOffset(uint64_t offset) {
+    return (offset + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT;
+}
+
+static SnapshotLayout calcLayout(uint64_t bodyCount, uint64_t floatArrayCount, uint64_t manifoldCount,
+                                 uint64_t manifoldSize) {
+
+    SnapshotLayout layout;
+
+    // every count is at most 32 bits, none of these products gets near 64
+    layout.floatArrayStride = alignOffset(bodyCount * sizeof(float));
+    layout.floatArraysOffset = alignOffset(sizeof(SnapshotHeader));
+    layout.awakeOffset = layout.floatArraysOffset + layout.floatArrayStride * floatArrayCount;
+    layout.manifoldsOffset = alignOffset(layout.awakeOffset + bodyCount);
+    layout.fileSize = layout.manifoldsOffset + manifoldCount * manifoldSize;
+
+    return layout;
+}
+
+void layoutSnapshot(SnapshotHeader& header, unsigned int bodyCount, unsigned int floatArrayCount,
+                    unsigned int manifoldCount, unsigned int manifoldSize) {
+
+    SnapshotLayout layout = calcLayout(bodyCount, floatArrayCount, manifoldCount, manifoldSize);
+    my_assert(layout.fileSize <= UINT32_MAX);
+
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.headerSize = sizeof(SnapshotHeader);
+
+    header.bodyCount = bodyCount;
+    header.floatArrayCount = floatArrayCount;
+    header.floatArrayStride = (uint32_t) layout.floatArrayStride;
+    header.manifoldCount = manifoldCount;
+    header.manifoldSize = manifoldSize;
+
+    header.floatArraysOffset = (uint32_t) layout.floatArraysOffset;
+    header.awakeOffset = (uint32_t) layout.awakeOffset;
+    header.manifoldsOffset = (uint32_t) layout.manifoldsOffset;
+
+    header.fileSize = (uint32_t) layout.fileSize;
+}
+
+bool checkSnapshotHeader(const SnapshotHeader& header, size_t size, unsigned int floatArrayCount,
+                         unsigned int manifoldSize) {
+
+    if (size < sizeof(SnapshotHeader) || header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION)
+        return false;
+
+    if (header.floatArrayCount != floatArrayCount || header.manifoldSize != manifoldSize)
+        return false;
+
+    // the offsets have to be the ones this build would write, then every array is where it is expected,
+    // and the last section has to end inside the data before anything is read from it
+    SnapshotLayout expected = calcLayout(header.bodyCount, floatArrayCount, header.manifoldCount, manifoldSize);
+
+    return header.headerSize == sizeof(SnapshotHeader) &&
+           header.floatArrayStride == expected.floatArrayStride &&
+           header.floatArraysOffset == expected.floatArraysOffset &&
+           header.awakeOffset == expected.awakeOffset &&
+           header.manifoldsOffset == expected.manifoldsOffset &&
+           header.fileSize == expected.fileSize &&
+           expected.fileSize <= size;
+}
+
+static const uint64_t STATE_HASH_PRIME = 1099511628211ULL;
+
+uint64_t hashStateWords(uint64_t hash, const void* words, size_t count) {
+
+    const unsigned char* data = (const unsigned char*) words;
+
+    for (size_t index = 0; index < count; index++) {
+
+        uint32_t word;
+        memcpy(&word, data + index * 4, sizeof(word));
+
+        hash = (hash ^ word) * STATE_HASH_PRIME;
+    }
+
+    return hash;
+}
+
+uint64_t hashStateBytes(uint64_t hash, const unsigned char* bytes, size_t count) {
+
+    for (size_t index = 0; index < count; index++)
+        hash = (hash ^ bytes[index]) * STATE_HASH_PRIME;
+
+    return hash;
+}
+
+bool isLittleEndianHost() {
+
+    const uint32_t probe = 1;
+    return *(const unsigned char*)&probe == 1;
+}
+
+static void swapWords(unsigned char* data, size_t size) {
+
+    for (size_t offset = 0; offset + 4 <= size; offset += 4) {
+
+        unsigned char* word = data + offset;
+
+        unsigned char byte = word[0];
+        word[0] = word[3];
+        word[3] = byte;
+
+        byte = word[1];
+        word[1] = word[2];
+        word[2] = byte;
+    }
+}
+
+void swapSnapshotHeader(SnapshotHeader& header) {
+    swapWords((unsigned char*) &header, sizeof(header));
+}
+
+void swapSnapshotByteOrder(unsigned char* snapshot, const SnapshotHeader& header) {
+
+    swapWords(snapshot + header.floatArraysOffset, header.floatArrayStride * header.floatArrayCount);
+    swapWords(snapshot + header.manifoldsOffset, header.manifoldCount * header.manifoldSize);
+    swapWords(snapshot, sizeof(SnapshotHeader));
+}
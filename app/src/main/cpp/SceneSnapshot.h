@@ -0,0 +1,67 @@
+#ifndef PHYSICSTEST_SCENE_SNAPSHOT_H
+#define PHYSICSTEST_SCENE_SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// binary snapshot of the whole simulation, laid out so it can be restored with one memcpy per array:
+//
+//   header | body float arrays, one per component, each body count long | awake flags | contact manifolds
+//
+// every section and every array starts at a multiple of SNAPSHOT_ALIGNMENT from the start of the file,
+// the file is little endian and made of 32 bit words, except the awake flags which are single bytes
+// the float arrays follow BodyStorage's component order and the manifolds are raw ContactManifold structs,
+// changing either means a new version
+struct SnapshotHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t fileSize;
+
+    uint32_t bodyCount;
+    uint32_t floatArrayCount;
+    // bytes from the start of one float array to the next
+    uint32_t floatArrayStride;
+    uint32_t manifoldCount;
+    uint32_t manifoldSize;
+
+    // from the start of the file
+    uint32_t floatArraysOffset;
+    uint32_t awakeOffset;
+    uint32_t manifoldsOffset;
+
+    float gravity[3];
+    // gravity when the bodies were last woken
+    float restingGravity[3];
+    float lastPenetration;
+
+    uint32_t velocityIterations;
+    uint32_t positionIterations;
+    uint32_t maxSubSteps;
+    uint32_t broadphaseType;
+};
+
+static const uint32_t SNAPSHOT_MAGIC = 0x53535450; // "PTSS"
+static const uint32_t SNAPSHOT_VERSION = 1;
+static const unsigned int SNAPSHOT_ALIGNMENT = 32;
+
+// fills the sizes and the offsets of the header for the given counts, leaves the scene fields alone
+void layoutSnapshot(SnapshotHeader& header, unsigned int bodyCount, unsigned int floatArrayCount,
+                    unsigned int manifoldCount, unsigned int manifoldSize);
+// false if the data doesn't start with a snapshot this build can read, the header has to be in host order
+bool checkSnapshotHeader(const SnapshotHeader& header, size_t size, unsigned int floatArrayCount,
+                         unsigned int manifoldSize);
+
+// FNV-1a over 32 bit words, chained through hash, for telling whether two runs are still in the same state,
+// words are hashed as values, so the result doesn't depend on the byte order
+static const uint64_t STATE_HASH_SEED = 14695981039346656037ULL;
+uint64_t hashStateWords(uint64_t hash, const void* words, size_t count);
+uint64_t hashStateBytes(uint64_t hash, const unsigned char* bytes, size_t count);
+
+bool isLittleEndianHost();
+void swapSnapshotHeader(SnapshotHeader& header);
+// swaps every 32 bit word of a snapshot between little endian and the host order, only needed on big endian hosts
+// header is the snapshot's header in host order
+void swapSnapshotByteOrder(unsigned char* snapshot, const SnapshotHeader& header);
+
+#endif //PHYSICSTEST_SCENE_SNAPSHOT_H
@@ -0,0 +1,102 @@
+#include "StateStorage.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+DirectoryStorage::DirectoryStorage(string directory) : directory(directory) {
+
+}
+
+void DirectoryStorage::setDirectory(string directory) {
+    this->directory = directory;
+}
+
+string DirectoryStorage::getDirectory() {
+    return this->directory;
+}
+
+string DirectoryStorage::getFullFileName(string fileName) {
+    return this->directory + "/" + fileName;
+}
+
+bool DirectoryStorage::loadBinaryFile(string fileName, void* dest, unsigned int size) {
+
+    bool result = false;
+
+    FILE* fileHandle = fopen(getFullFileName(fileName).c_str(), "rb");
+    if (fileHandle != nullptr) {
+
+        size_t readed = fread(dest, 1, size, fileHandle);
+        if (readed == size)
+            result = true;
+
+        fclose(fileHandle);
+        fileHandle = nullptr;
+    }
+
+    return result;
+}
+
+bool DirectoryStorage::loadBinaryFile(string fileName, vector<unsigned char>& dest) {
+
+    FILE* fileHandle = fopen(getFullFileName(fileName).c_str(), "rb");
+    if (fileHandle == nullptr)
+        return false;
+
+    bool result = false;
+
+    if (fseek(fileHandle, 0, SEEK_END) == 0) {
+
+        long size = ftell(fileHandle);
+        if (size >= 0 && fseek(fileHandle, 0, SEEK_SET) == 0) {
+
+            dest.resize((size_t) size);
+            result = size == 0 || fread(dest.data(), 1, (size_t) size, fileHandle) == (size_t) size;
+        }
+    }
+
+    fclose(fileHandle);
+    fileHandle = nullptr;
+
+    return result;
+}
+
+bool DirectoryStorage::mapBinaryFile(string fileName, MappedFile& file) {
+    return file.open(getFullFileName(fileName));
+}
+
+bool DirectoryStorage::saveBinaryFile(string fileName, const void* src, unsigned int size) {
+
+    string fullFileName = getFullFileName(fileName);
+    string tempFileName = fullFileName + ".tmp";
+
+    FILE* fileHandle = fopen(tempFileName.c_str(), "wb");
+    if (fileHandle == nullptr)
+        return false;
+
+    bool written = fwrite(src, 1, size, fileHandle) == size && fflush(fileHandle) == 0 &&
+                   fsync(fileno(fileHandle)) == 0;
+
+    written = fclose(fileHandle) == 0 && written;
+    fileHandle = nullptr;
+
+    // a torn temporary file never replaces the last good one
+    if (!written || rename(tempFileName.c_str(), fullFileName.c_str()) != 0) {
+        unlink(tempFileName.c_str());
+        return false;
+    }
+
+    // the rename itself only survives a power loss once the directory is synced
+    int directoryHandle = open(this->directory.c_str(), O_RDONLY);
+    if (directoryHandle >= 0) {
+        fsync(directoryHandle);
+        close(directoryHandle);
+    }
+
+    return true;
+}
+
+bool DirectoryStorage::renameBinaryFile(string fileName, string newFileName) {
+    return rename(getFullFileName(fileName).c_str(), getFullFileName(newFileName).c_str()) == 0;
+}
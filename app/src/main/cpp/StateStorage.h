@@ -0,0 +1,48 @@
+#ifndef PHYSICSTEST_STATE_STORAGE_H
+#define PHYSICSTEST_STATE_STORAGE_H
+
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+using namespace std;
+
+// where the physics keeps its files between runs
+class StateStorage {
+public:
+    virtual ~StateStorage() {}
+
+    // false if the file is missing or shorter than size
+    virtual bool loadBinaryFile(string fileName, void* dest, unsigned int size) = 0;
+    // the whole file, false if it is missing
+    virtual bool loadBinaryFile(string fileName, vector<unsigned char>& dest) = 0;
+    // the whole file without copying it, false if it is missing
+    virtual bool mapBinaryFile(string fileName, MappedFile& file) = 0;
+    // all or nothing: the old file stays as it was unless the whole new one made it to the disk
+    virtual bool saveBinaryFile(string fileName, const void* src, unsigned int size) = 0;
+    // replaces newFileName if it exists, false if fileName is missing
+    virtual bool renameBinaryFile(string fileName, string newFileName) = 0;
+};
+
+// plain files in a directory, the app's external files directory on the device
+class DirectoryStorage : public StateStorage {
+private:
+    string directory;
+
+    string getFullFileName(string fileName);
+public:
+    DirectoryStorage(string directory = ".");
+
+    void setDirectory(string directory);
+    string getDirectory();
+
+    bool loadBinaryFile(string fileName, void* dest, unsigned int size) override;
+    bool loadBinaryFile(string fileName, vector<unsigned char>& dest) override;
+    bool mapBinaryFile(string fileName, MappedFile& file) override;
+    // written to a temporary file next to it, synced and renamed over the old one
+    bool saveBinaryFile(string fileName, const void* src, unsigned int size) override;
+    bool renameBinaryFile(string fileName, string newFileName) override;
+};
+
+#endif //PHYSICSTEST_STATE_STORAGE_H
@@ -0,0 +1,139 @@
+#include "SweepAndPruneBroadphase.h"
+
+#include <algorithm>
+
+SweepAndPruneBroadphase::SweepAndPruneBroadphase() : aabbs(nullptr), count(0), sweepAxis(0) {
+
+    for (unsigned int axis = 0; axis < AXIS_COUNT; axis++)
+        maxExtents[axis] = 0;
+}
+
+const char* SweepAndPruneBroadphase::getName() const {
+    return "sweep and prune";
+}
+
+void SweepAndPruneBroadphase::update(const Aabb* aabbs, unsigned int count) {
+
+    unsigned int oldCount = this->count;
+
+    this->aabbs = aabbs;
+    this->count = count;
+
+    for (unsigned int axis = 0; axis < AXIS_COUNT; axis++)
+        updateAxis(axis, oldCount);
+
+    chooseSweepAxis();
+}
+
+void SweepAndPruneBroadphase::updateAxis(unsigned int axis, unsigned int oldCount) {
+
+    vector<Endpoint>& axisEndpoints = endpoints[axis];
+
+    // drop bodies that no longer exist, add the new ones at the end
+    if (count < oldCount) {
+        axisEndpoints.erase(remove_if(axisEndpoints.begin(), axisEndpoints.end(),
+                                      [this](const Endpoint& endpoint) { return endpoint.body >= count; }),
+                            axisEndpoints.end());
+    }
+
+    for (unsigned int body = oldCount; body < count; body++)
+        axisEndpoints.push_back({ 0, 0, body });
+
+    maxExtents[axis] = 0;
+
+    for (Endpoint& endpoint : axisEndpoints) {
+        const Aabb& aabb = aabbs[endpoint.body];
+        endpoint.min = aabb.min[axis];
+        endpoint.max = aabb.max[axis];
+        maxExtents[axis] = std::max(maxExtents[axis], endpoint.max - endpoint.min);
+    }
+
+    // many new bodies out of order, insertion sort would go quadratic
+    if (count > oldCount && count - oldCount > count / 16 + 1) {
+        sort(axisEndpoints.begin(), axisEndpoints.end(),
+             [](const Endpoint& a, const Endpoint& b) { return a.min < b.min; });
+        return;
+    }
+
+    for (unsigned int index = 1; index < axisEndpoints.size(); index++) {
+
+        Endpoint endpoint = axisEndpoints[index];
+
+        unsigned int position = index;
+        while (position > 0 && axisEndpoints[position - 1].min > endpoint.min) {
+            axisEndpoints[position] = axisEndpoints[position - 1];
+            position--;
+        }
+
+        axisEndpoints[position] = endpoint;
+    }
+}
+
+void SweepAndPruneBroadphase::chooseSweepAxis() {
+
+    if (count == 0)
+        return;
+
+    // the axis along which the box centers are spread the most has the fewest overlapping intervals
+    vec3 sum = vec3(0), sumSq = vec3(0);
+
+    for (unsigned int body = 0; body < count; body++) {
+        vec3 center = (aabbs[body].min + aabbs[body].max) * 0.5f;
+        sum += center;
+        sumSq += center * center;
+    }
+
+    vec3 variance = sumSq - sum * sum / (float)count;
+
+    sweepAxis = 0;
+    if (variance.y > variance[sweepAxis])
+        sweepAxis = 1;
+    if (variance.z > variance[sweepAxis])
+        sweepAxis = 2;
+}
+
+void SweepAndPruneBroadphase::findPairs(vector<BodyPair>& pairs) {
+
+    const vector<Endpoint>& axisEndpoints = endpoints[sweepAxis];
+
+    unsigned int endpointCount = (unsigned int)axisEndpoints.size();
+
+    for (unsigned int index = 0; index < endpointCount; index++) {
+
+        const Endpoint& endpoint = axisEndpoints[index];
+        const Aabb& aabb = aabbs[endpoint.body];
+
+        for (unsigned int otherIndex = index + 1; otherIndex < endpointCount; otherIndex++) {
+
+            const Endpoint& other = axisEndpoints[otherIndex];
+
+            // sorted by min, nothing further along can overlap on this axis
+            if (other.min > endpoint.max)
+                break;
+
+            if (!aabb.overlaps(aabbs[other.body]))
+                continue;
+
+            if (endpoint.body < other.body)
+                pairs.push_back({ endpoint.body, other.body });
+            else
+                pairs.push_back({ other.body, endpoint.body });
+        }
+    }
+}
+
+void SweepAndPruneBroadphase::query(const Aabb& aabb, vector<unsigned int>& bodies) {
+
+    const vector<Endpoint>& axisEndpoints = endpoints[sweepAxis];
+
+    // no interval is longer than the longest one, so nothing starting before this reaches the box
+    float first = aabb.min[sweepAxis] - maxExtents[sweepAxis];
+
+    vector<Endpoint>::const_iterator endpoint =
+        lower_bound(axisEndpoints.begin(), axisEndpoints.end(), first,
+                    [](const Endpoint& endpoint, float min) { return endpoint.min < min; });
+
+    for (; endpoint != axisEndpoints.end() && endpoint->min <= aabb.max[sweepAxis]; ++endpoint)
+        if (aabbs[endpoint->body].overlaps(aabb))
+            bodies.push_back(endpoint->body);
+}
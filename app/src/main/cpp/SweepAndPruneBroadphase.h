@@ -0,0 +1,44 @@
+#ifndef PHYSICSTEST_SWEEP_AND_PRUNE_BROADPHASE_H
+#define PHYSICSTEST_SWEEP_AND_PRUNE_BROADPHASE_H
+
+#include <vector>
+
+#include "Broadphase.h"
+
+using namespace std;
+
+// incremental sweep and prune
+// bodies stay sorted by their interval on all three axes between steps, so with coherent motion
+// re-sorting is a nearly linear insertion sort, and the sweep can move to whichever axis
+// currently separates the bodies best without a full sort
+class SweepAndPruneBroadphase : public Broadphase {
+private:
+    struct Endpoint {
+        float min, max;
+        unsigned int body;
+    };
+
+    static const unsigned int AXIS_COUNT = 3;
+
+    vector<Endpoint> endpoints[AXIS_COUNT];
+    // longest interval on every axis, bounds how far before a query box an overlapping min can be
+    float maxExtents[AXIS_COUNT];
+
+    const Aabb* aabbs;
+    unsigned int count;
+
+    unsigned int sweepAxis;
+
+    void updateAxis(unsigned int axis, unsigned int oldCount);
+    void chooseSweepAxis();
+public:
+    SweepAndPruneBroadphase();
+
+    const char* getName() const override;
+
+    void update(const Aabb* aabbs, unsigned int count) override;
+    void findPairs(vector<BodyPair>& pairs) override;
+    void query(const Aabb& aabb, vector<unsigned int>& bodies) override;
+};
+
+#endif //PHYSICSTEST_SWEEP_AND_PRUNE_BROADPHASE_H
@@ -0,0 +1,62 @@
+#ifndef PHYSICSTEST_TRIPLE_BUFFER_H
+#define PHYSICSTEST_TRIPLE_BUFFER_H
+
+#include <atomic>
+
+// std:: is spelled out on the atomics, moodycamel brings its own memory_order next to readerwriterqueue.h
+using namespace std;
+
+// lock-free handoff from one writer thread to one reader thread: the writer fills the back buffer and publishes it,
+// the reader takes the newest published buffer, neither ever waits for the other and skipped buffers are overwritten
+template <typename T>
+class TripleBuffer {
+private:
+    // set on the middle index once the writer published it and the reader hasn't taken it yet
+    static const unsigned int FRESH = 4;
+    static const unsigned int INDEX_MASK = 3;
+
+    T buffers[3];
+
+    // owned by the writer
+    unsigned int back;
+    // handed between the threads
+    std::atomic<unsigned int> middle;
+    // owned by the reader
+    unsigned int front;
+public:
+    TripleBuffer() : back(0), middle(1), front(2) {
+
+    }
+
+    TripleBuffer(TripleBuffer const&) = delete;
+    void operator=(TripleBuffer const&) = delete;
+
+    // writer side
+
+    T& getBack() {
+        return buffers[back];
+    }
+
+    void publish() {
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // reader side
+
+    // false if nothing was published since the last call, the front buffer stays as it was
+    bool update() {
+
+        if ((middle.load(std::memory_order_relaxed) & FRESH) == 0)
+            return false;
+
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+
+        return true;
+    }
+
+    const T& getFront() const {
+        return buffers[front];
+    }
+};
+
+#endif //PHYSICSTEST_TRIPLE_BUFFER_H
@@ -0,0 +1,172 @@
+#include "UniformGridBroadphase.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+constexpr float UniformGridBroadphase::CELL_SCALE;
+constexpr float UniformGridBroadphase::CELL_SIZE_TOLERANCE;
+
+UniformGridBroadphase::UniformGridBroadphase(const Aabb& bounds) :
+    bounds(bounds), cellSize(0), dims(1), aabbs(nullptr), count(0) {
+
+}
+
+const char* UniformGridBroadphase::getName() const {
+    return "uniform grid";
+}
+
+void UniformGridBroadphase::chooseCellSize() {
+
+    if (count == 0)
+        return;
+
+    // median of the largest extent over a strided sample of the bodies
+    unsigned int stride = std::max(1u, count / SIZE_SAMPLES);
+
+    sizeSamples.clear();
+    for (unsigned int body = 0; body < count; body += stride) {
+        vec3 extent = aabbs[body].max - aabbs[body].min;
+        sizeSamples.push_back(std::max(extent.x, std::max(extent.y, extent.z)));
+    }
+
+    vector<float>::iterator median = sizeSamples.begin() + sizeSamples.size() / 2;
+    nth_element(sizeSamples.begin(), median, sizeSamples.end());
+
+    // a grid finer than this would have more cells than the limit
+    vec3 boundsSize = bounds.max - bounds.min;
+    float minSize = cbrtf(boundsSize.x * boundsSize.y * boundsSize.z / (float)(count * MAX_CELLS_PER_BODY));
+
+    float size = std::max(*median * CELL_SCALE, minSize);
+
+    if (cellSize > 0 && fabsf(size - cellSize) <= cellSize * CELL_SIZE_TOLERANCE)
+        return;
+
+    this->cellSize = size;
+
+    for (unsigned int axis = 0; axis < 3; axis++)
+        dims[axis] = std::max(1, (int)ceilf(boundsSize[axis] / size));
+}
+
+ivec3 UniformGridBroadphase::getCell(vec3 point) const {
+
+    vec3 cell = floor((point - bounds.min) / cellSize);
+
+    // clamped in float first, points far outside the bounds would overflow the int conversion
+    cell = glm::max(cell, vec3(0));
+    cell = glm::min(cell, vec3(dims - ivec3(1)));
+
+    return ivec3(cell);
+}
+
+unsigned int UniformGridBroadphase::getCellIndex(ivec3 cell) const {
+    return (unsigned int)(cell.x + dims.x * (cell.y + dims.y * cell.z));
+}
+
+void UniformGridBroadphase::update(const Aabb* aabbs, unsigned int count) {
+
+    this->aabbs = aabbs;
+    this->count = count;
+
+    chooseCellSize();
+
+    unsigned int cellCount = (unsigned int)(dims.x * dims.y * dims.z);
+
+    cellMin.resize(count);
+    cellMax.resize(count);
+
+    // counting sort of the bodies into every cell they touch
+    cellStart.assign(cellCount + 1, 0);
+
+    unsigned int entryCount = 0;
+    for (unsigned int body = 0; body < count; body++) {
+
+        ivec3 min = getCell(aabbs[body].min), max = getCell(aabbs[body].max);
+        cellMin[body] = min;
+        cellMax[body] = max;
+
+        for (int z = min.z; z <= max.z; z++)
+            for (int y = min.y; y <= max.y; y++)
+                for (int x = min.x; x <= max.x; x++)
+                    cellStart[getCellIndex(ivec3(x, y, z))]++;
+
+        entryCount += (max.x - min.x + 1) * (max.y - min.y + 1) * (max.z - min.z + 1);
+    }
+
+    // running sum turns the counts into cell ends
+    for (unsigned int cell = 1; cell <= cellCount; cell++)
+        cellStart[cell] += cellStart[cell - 1];
+
+    // filling backwards moves every end to its start and leaves each cell sorted by body index
+    cellBodies.resize(entryCount);
+
+    for (unsigned int body = count; body-- > 0;) {
+
+        ivec3 min = cellMin[body], max = cellMax[body];
+
+        for (int z = min.z; z <= max.z; z++)
+            for (int y = min.y; y <= max.y; y++)
+                for (int x = min.x; x <= max.x; x++)
+                    cellBodies[--cellStart[getCellIndex(ivec3(x, y, z))]] = body;
+    }
+}
+
+void UniformGridBroadphase::findPairs(vector<BodyPair>& pairs) {
+
+    unsigned int cell = 0;
+
+    for (int z = 0; z < dims.z; z++) {
+        for (int y = 0; y < dims.y; y++) {
+            for (int x = 0; x < dims.x; x++, cell++) {
+
+                unsigned int begin = cellStart[cell], end = cellStart[cell + 1];
+
+                for (unsigned int i = begin; i < end; i++) {
+
+                    unsigned int a = cellBodies[i];
+
+                    for (unsigned int j = i + 1; j < end; j++) {
+
+                        unsigned int b = cellBodies[j];
+
+                        if (!aabbs[a].overlaps(aabbs[b]))
+                            continue;
+
+                        // bodies sharing several cells meet in each of them,
+                        // only the cell holding the min corner of their overlap reports the pair
+                        ivec3 owner = glm::max(cellMin[a], cellMin[b]);
+                        if (owner.x == x && owner.y == y && owner.z == z)
+                            pairs.push_back({ a, b });
+                    }
+                }
+            }
+        }
+    }
+}
+
+void UniformGridBroadphase::query(const Aabb& aabb, vector<unsigned int>& bodies) {
+
+    if (count == 0)
+        return;
+
+    ivec3 min = getCell(aabb.min), max = getCell(aabb.max);
+
+    for (int z = min.z; z <= max.z; z++) {
+        for (int y = min.y; y <= max.y; y++) {
+            for (int x = min.x; x <= max.x; x++) {
+
+                unsigned int cell = getCellIndex(ivec3(x, y, z));
+
+                for (unsigned int entry = cellStart[cell]; entry < cellStart[cell + 1]; entry++) {
+
+                    unsigned int body = cellBodies[entry];
+
+                    // a body in several of the cells is reported from the first one it shares with the box
+                    ivec3 owner = glm::max(cellMin[body], min);
+                    if (owner.x == x && owner.y == y && owner.z == z && aabbs[body].overlaps(aabb))
+                        bodies.push_back(body);
+                }
+            }
+        }
+    }
+}
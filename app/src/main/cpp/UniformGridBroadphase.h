@@ -0,0 +1,57 @@
+#ifndef PHYSICSTEST_UNIFORM_GRID_BROADPHASE_H
+#define PHYSICSTEST_UNIFORM_GRID_BROADPHASE_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "Broadphase.h"
+
+using namespace glm;
+using namespace std;
+
+// uniform grid over a fixed box (the walls), rebuilt every update with a counting sort
+// cell size follows the median body size, so a typical body touches 1 to 8 cells
+// bodies sticking out of the box are clamped to the border cells, which keeps the result exact
+class UniformGridBroadphase : public Broadphase {
+private:
+    // cell edge relative to the median body extent
+    static constexpr float CELL_SCALE = 1.0f;
+    // upper bound on the cell count relative to the body count, coarsens the grid for sparse scenes
+    static const unsigned int MAX_CELLS_PER_BODY = 4;
+    // the cell size is re-picked only when the median drifts further than this
+    static constexpr float CELL_SIZE_TOLERANCE = 0.25f;
+    // bodies sampled to estimate the median extent
+    static const unsigned int SIZE_SAMPLES = 255;
+
+    Aabb bounds;
+
+    float cellSize;
+    ivec3 dims;
+
+    const Aabb* aabbs;
+    unsigned int count;
+
+    // cell range of every body, inclusive
+    vector<ivec3> cellMin, cellMax;
+
+    // bodies of cell c are cellBodies[cellStart[c], cellStart[c + 1])
+    vector<unsigned int> cellStart;
+    vector<unsigned int> cellBodies;
+
+    vector<float> sizeSamples;
+
+    void chooseCellSize();
+    ivec3 getCell(vec3 point) const;
+    unsigned int getCellIndex(ivec3 cell) const;
+public:
+    UniformGridBroadphase(const Aabb& bounds);
+
+    const char* getName() const override;
+
+    void update(const Aabb* aabbs, unsigned int count) override;
+    void findPairs(vector<BodyPair>& pairs) override;
+    void query(const Aabb& aabb, vector<unsigned int>& bodies) override;
+};
+
+#endif //PHYSICSTEST_UNIFORM_GRID_BROADPHASE_H
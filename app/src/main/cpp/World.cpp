@@ -0,0 +1,118 @@
+#include "World.h"
+
+const BodyHandle World::INVALID_HANDLE = { World::INVALID_INDEX, 0 };
+
+BodyHandle World::addBody(vec3 position, quat orientation, vec3 size, float mass) {
+
+    unsigned int slotIndex;
+    if (!freeSlots.empty()) {
+        slotIndex = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slotIndex = (unsigned int)slots.size();
+        slots.push_back({ 0, 0 });
+    }
+
+    Slot& slot = slots[slotIndex];
+    slot.denseIndex = bodies.add(position, orientation, size, mass);
+
+    denseToSlot.push_back(slotIndex);
+
+    return { slotIndex, slot.generation };
+}
+
+void World::removeBody(BodyHandle handle) {
+
+    if (!isValid(handle))
+        return;
+
+    Slot& slot = slots[handle.index];
+
+    unsigned int index = slot.denseIndex;
+    unsigned int lastIndex = bodies.size() - 1;
+
+    bodies.remove(index);
+
+    if (index != lastIndex) {
+        denseToSlot[index] = denseToSlot[lastIndex];
+        slots[denseToSlot[index]].denseIndex = index;
+    }
+
+    denseToSlot.pop_back();
+
+    // invalidates every outstanding handle to this slot
+    slot.generation++;
+    freeSlots.push_back(handle.index);
+}
+
+void World::clear() {
+
+    for (unsigned int index = 0; index < denseToSlot.size(); index++) {
+        unsigned int slotIndex = denseToSlot[index];
+        slots[slotIndex].generation++;
+        freeSlots.push_back(slotIndex);
+    }
+
+    bodies.clear();
+    denseToSlot.clear();
+}
+
+void World::loadState(unsigned int count, const unsigned char* floatArrays, unsigned int stride,
+                      const unsigned char* awake) {
+
+    clear();
+    bodies.loadState(count, floatArrays, stride, awake);
+
+    for (unsigned int index = 0; index < count; index++) {
+
+        unsigned int slotIndex;
+        if (!freeSlots.empty()) {
+            slotIndex = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            slotIndex = (unsigned int)slots.size();
+            slots.push_back({ 0, 0 });
+        }
+
+        slots[slotIndex].denseIndex = index;
+        denseToSlot.push_back(slotIndex);
+    }
+}
+
+void World::reserve(unsigned int bodyCount) {
+
+    bodies.reserve(bodyCount);
+    denseToSlot.reserve(bodyCount);
+    slots.reserve(bodyCount);
+}
+
+bool World::isValid(BodyHandle handle) const {
+    return handle.index < slots.size() && slots[handle.index].generation == handle.generation;
+}
+
+unsigned int World::getBodyCount() const {
+    return bodies.size();
+}
+
+unsigned int World::getIndex(BodyHandle handle) const {
+
+    if (!isValid(handle))
+        return INVALID_INDEX;
+
+    return slots[handle.index].denseIndex;
+}
+
+BodyHandle World::getHandle(unsigned int index) const {
+
+    unsigned int slotIndex = denseToSlot[index];
+
+    return { slotIndex, slots[slotIndex].generation };
+}
+
+BodyStorage& World::getBodies() {
+    return bodies;
+}
+
+const BodyStorage& World::getBodies() const {
+    return bodies;
+}
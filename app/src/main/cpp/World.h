@@ -0,0 +1,59 @@
+#ifndef PHYSICSTEST_WORLD_H
+#define PHYSICSTEST_WORLD_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <vector>
+
+#include "BodyStorage.h"
+
+using namespace glm;
+using namespace std;
+
+// stable reference to a body, stays valid while bodies around it are added and removed
+struct BodyHandle {
+    unsigned int index;
+    unsigned int generation;
+};
+
+// registry of dynamic bodies
+// bodies are kept densely packed (removal swaps the last body into the hole),
+// handles are resolved through a slot table so they survive that reordering
+class World {
+private:
+    struct Slot {
+        unsigned int denseIndex;
+        unsigned int generation;
+    };
+
+    BodyStorage bodies;
+    vector<unsigned int> denseToSlot;
+
+    vector<Slot> slots;
+    vector<unsigned int> freeSlots;
+public:
+    static const BodyHandle INVALID_HANDLE;
+    static const unsigned int INVALID_INDEX = 0xFFFFFFFF;
+
+    BodyHandle addBody(vec3 position, quat orientation, vec3 size, float mass);
+    void removeBody(BodyHandle handle);
+    void clear();
+    // replaces every body with the ones of a snapshot, see BodyStorage::loadState, old handles become invalid
+    void loadState(unsigned int count, const unsigned char* floatArrays, unsigned int stride,
+                   const unsigned char* awake);
+
+    void reserve(unsigned int bodyCount);
+
+    bool isValid(BodyHandle handle) const;
+    unsigned int getBodyCount() const;
+
+    // dense access, indices are only valid until the next add/remove
+    unsigned int getIndex(BodyHandle handle) const;
+    BodyHandle getHandle(unsigned int index) const;
+
+    BodyStorage& getBodies();
+    const BodyStorage& getBodies() const;
+};
+
+#endif //PHYSICSTEST_WORLD_H
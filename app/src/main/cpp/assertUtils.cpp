@@ -0,0 +1,24 @@
+#include "assertUtils.h"
+
+#include <signal.h>
+#include <stdio.h>
+
+#include <stdexcept>
+#include <string>
+
+void my_assert(bool condition) {
+
+    if (!condition)
+        raise(SIGABRT);
+}
+
+void pthread_check_error(int ret) {
+
+    if (ret != 0) {
+
+        char error_msg[128];
+        snprintf(error_msg, sizeof(error_msg), "pthread error: %d", ret);
+
+        throw std::runtime_error(std::string(error_msg));
+    }
+}
@@ -0,0 +1,9 @@
+#ifndef PHYSICSTEST_ASSERT_UTILS_H
+#define PHYSICSTEST_ASSERT_UTILS_H
+
+// checks shared by the app and the physics core, free of JNI and EGL so the core builds on a desktop host
+
+void my_assert(bool condition);
+void pthread_check_error(int ret);
+
+#endif //PHYSICSTEST_ASSERT_UTILS_H
@@ -61,23 +61,6 @@ void swallow_cpp_exception_and_throw_java(JNIEnv *env) {
     }
 }
 
-void my_assert(bool condition) {
-
-    if (!condition)
-        raise(SIGABRT);
-}
-
-void pthread_check_error(int ret) {
-
-    if (ret != 0) {
-
-        char error_msg[128];
-        snprintf(error_msg, sizeof(error_msg), "pthread error: %d", ret);
-
-        throw std::runtime_error(std::string(error_msg));
-    }
-}
-
 void eglCheckError(bool condition, const char* functionName) {
 
     if (!condition) {
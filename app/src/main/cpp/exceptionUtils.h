@@ -3,10 +3,10 @@
 
 #include <jni.h>
 
+#include "assertUtils.h"
+
 inline void assert_no_exception(JNIEnv *env);
 void swallow_cpp_exception_and_throw_java(JNIEnv *env);
-void my_assert(bool condition);
-void pthread_check_error(int ret);
 void eglCheckError(bool condition, const char* functionName);
 
 #endif //PEOPLEWATCHER_EXCEPTIONUTILS_H
\ No newline at end of file
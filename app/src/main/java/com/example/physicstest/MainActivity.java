@@ -40,6 +40,8 @@ public class MainActivity extends Activity implements SurfaceHolder.Callback {
     @Override
     protected void onResume() {
         super.onResume();
+        // frames follow the display, 90 and 120 Hz panels included
+        JNIHandler.setRefreshRate(getWindowManager().getDefaultDisplay().getRefreshRate());
         JNIHandler.start();
         setOutputSurfaceFromHolder();
     }